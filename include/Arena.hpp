@@ -0,0 +1,35 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator for objects that all die together, such as the nodes of one parsed program.
+// Memory is handed out from large blocks and only returned when the arena itself is destroyed;
+// destructors of the objects are the owner's responsibility.
+class Arena {
+public:
+    explicit Arena(size_t block_size = default_block_size);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment);
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+private:
+    static constexpr size_t default_block_size = 64u * 1024u;
+
+    size_t block_size;
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    std::byte* cursor = nullptr;
+    std::byte* end = nullptr;
+};
+
+#endif // ARENA_HPP
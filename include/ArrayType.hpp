@@ -0,0 +1,44 @@
+#ifndef ARRAY_TYPE_HPP
+#define ARRAY_TYPE_HPP
+
+#include "Value.hpp"
+#include <span>
+#include <vector>
+
+// A fixed-length sequence of numbers stored unboxed, one double after another, so that the
+// kernels below can run over it with vector instructions.
+class Array : public Object {
+public:
+    explicit Array(std::vector<double> values);
+
+    size_t length() const noexcept { return values.size(); }
+    double& at(size_t index) { return values[index]; }
+    std::span<const double> elements() const noexcept { return values; }
+    std::string toString() const override;
+    void appendTo(std::string& out) const override;
+
+private:
+    std::vector<double> values;
+};
+
+enum class ArrayOperation { ADD, SUBTRACT, MULTIPLY, DIVIDE };
+
+// Applies 'op' element by element to two arrays of the same length, or to an array and a number.
+// Division follows IEEE rules, so dividing by zero gives an infinity or NaN instead of an error.
+// Throws NativeError when the operands do not fit.
+Value elementwise(ArrayOperation op, const Value& lhs, const Value& rhs);
+
+// Kernels over contiguous doubles. They use AVX2 when the CPU has it; the portable versions add
+// up in the same order, so results do not depend on the machine. min and max skip NaN elements and
+// need at least one element; dot needs two spans of the same length.
+namespace kernels {
+
+double sum(std::span<const double> values) noexcept;
+double min(std::span<const double> values) noexcept;
+double max(std::span<const double> values) noexcept;
+double dot(std::span<const double> lhs, std::span<const double> rhs) noexcept;
+std::vector<double> scale(std::span<const double> values, double factor);
+
+} // namespace kernels
+
+#endif // ARRAY_TYPE_HPP
@@ -1,34 +1,77 @@
 #ifndef BUILT_IN_HPP
 #define BUILT_IN_HPP
 
+#include "ArrayType.hpp"
 #include "Callable.hpp"
 #include "FunctionType.hpp"
+#include "Output.hpp"
+#include "RuntimeError.hpp"
 #include <chrono>
 #include <iostream>
 #include <sstream>
 #include <string>
 
-class ClockCallable : public Callable {
+class ClockCallable : public NativeCallable {
 public:
     size_t getArity() const override;
-    std::any call(Interpreter& interpreter, const std::vector<std::any>& args) const override;
+    Value callNative(std::span<const Value> args) const override;
     std::string toString() const override;
+};
+
+class PrintCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
+};
+
+class FlushCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
+};
+
+class ArrayCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
+};
 
-private:
-    size_t arity = 0u;
+class SumCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
+};
+
+class MinCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
 };
 
-class PrintCallable : public Callable {
+class MaxCallable : public NativeCallable {
 public:
-    explicit PrintCallable(size_t arity = 0u) : arity{arity} {}
     size_t getArity() const override;
-    std::any call(Interpreter& interpreter, const std::vector<std::any>& args) const override;
+    Value callNative(std::span<const Value> args) const override;
     std::string toString() const override;
+};
 
-private:
-    size_t arity;
+class DotCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
 };
 
-std::string stringify(const std::any& item, std::stringstream& stream);
+class ScaleCallable : public NativeCallable {
+public:
+    size_t getArity() const override;
+    Value callNative(std::span<const Value> args) const override;
+    std::string toString() const override;
+};
 
-#endif // BUILT_IN_HPP
\ No newline at end of file
+#endif // BUILT_IN_HPP
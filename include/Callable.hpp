@@ -1,19 +1,31 @@
-
 #ifndef CALLABLE_HPP
 #define CALLABLE_HPP
 
-#include <any>
+#include "Value.hpp"
+#include <limits>
+#include <span>
 #include <string>
-#include <vector>
 
 class Interpreter;
 
-class Callable {
+class Callable : public Object {
 public:
+    // Arity of callables accepting any number of arguments.
+    static constexpr size_t variadic = std::numeric_limits<size_t>::max();
+
     virtual size_t getArity() const = 0;
-    virtual std::any call(Interpreter& interpreter, const std::vector<std::any>& args) const = 0;
-    virtual std::string toString() const = 0;
-    virtual ~Callable() = default;
+    virtual Value call(Interpreter& interpreter, std::span<const Value> args) const = 0;
+};
+
+// Built-in functions. They do not depend on the tree-walking interpreter, so the VM can call
+// them directly.
+class NativeCallable : public Callable {
+public:
+    Value call(Interpreter& interpreter, std::span<const Value> args) const final {
+        return callNative(args);
+    }
+
+    virtual Value callNative(std::span<const Value> args) const = 0;
 };
 
-#endif // CALLABLE_HPP
\ No newline at end of file
+#endif // CALLABLE_HPP
@@ -0,0 +1,74 @@
+#ifndef CHUNK_HPP
+#define CHUNK_HPP
+
+#include "Value.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class OpCode : uint8_t {
+    CONSTANT,      // u16 constant index
+    NIL,
+    TRUE,
+    FALSE,
+    POP,
+    DUP,
+    GET_LOCAL,     // u16 slot
+    SET_LOCAL,     // u16 slot
+    GET_GLOBAL,    // u16 name constant
+    DEFINE_GLOBAL, // u16 name constant
+    SET_GLOBAL,    // u16 name constant
+    GET_UPVALUE,   // u16 upvalue index
+    SET_UPVALUE,   // u16 upvalue index
+    EQUAL,
+    NOT_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    NOT,
+    NEGATE,
+    INCREMENT,     // u16 name constant (for error messages)
+    DECREMENT,     // u16 name constant (for error messages)
+    BUILD_LIST,    // u8 item count
+    GET_INDEX,     // u16 name constant (for error messages)
+    SET_INDEX,     // u16 name constant (for error messages)
+    JUMP,          // u16 forward offset
+    JUMP_IF_FALSE, // u16 forward offset
+    LOOP,          // u16 backward offset
+    CALL,          // u8 argument count
+    TAIL_CALL,     // u8 argument count; a closure callee replaces the current frame
+    CLOSURE,       // u16 function index, then (u8 is_local, u16 index) per upvalue
+    CLOSE_UPVALUE,
+    RETURN
+};
+
+struct CompiledFunction;
+
+struct Chunk {
+    std::vector<uint8_t> code;
+    std::vector<Value> constants;
+    std::vector<std::shared_ptr<CompiledFunction>> functions;
+    std::vector<unsigned int> lines;
+
+    void write(uint8_t byte, unsigned int line);
+    size_t addConstant(Value value);
+    size_t addFunction(std::shared_ptr<CompiledFunction> function);
+};
+
+// A function body lowered to bytecode by the Compiler.
+struct CompiledFunction {
+    std::string name;
+    size_t arity = 0u;
+    size_t upvalue_count = 0u;
+    // Values its frame holds at most: the function itself, its locals and temporaries.
+    size_t stack_size = 1u;
+    Chunk chunk;
+};
+
+#endif // CHUNK_HPP
@@ -0,0 +1,113 @@
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include "Chunk.hpp"
+#include "ExprNode.hpp"
+#include "StmtNode.hpp"
+#include "Symbol.hpp"
+#include "Visitor.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lowers the resolved AST into bytecode for the VM.
+class Compiler : public ExprVisitor<std::any>, public StmtVisitor {
+public:
+    std::shared_ptr<CompiledFunction> compile(const std::vector<unique_stmt_ptr>& statements);
+
+    std::any visit(const BinaryExpr& expr) override;
+    std::any visit(const UnaryExpr& expr) override;
+    std::any visit(const GroupingExpr& expr) override;
+    std::any visit(const LiteralExpr& expr) override;
+    std::any visit(const AssignExpr& expr) override;
+    std::any visit(const CallExpr& expr) override;
+    std::any visit(const SetExpr& expr) override;
+    std::any visit(const GetExpr& expr) override;
+    std::any visit(const SuperExpr& expr) override;
+    std::any visit(const LogicalExpr& expr) override;
+    std::any visit(const ThisExpr& expr) override;
+    std::any visit(const VarExpr& expr) override;
+    std::any visit(const ListExpr& expr) override;
+    std::any visit(const SubscriptExpr& expr) override;
+    std::any visit(const IncrementExpr& expr) override;
+    std::any visit(const DecrementExpr& expr) override;
+
+    void visit(const BlockStmt& stmt) override;
+    void visit(const ClassStmt& stmt) override;
+    void visit(const ExprStmt& stmt) override;
+    void visit(const FnStmt& stmt) override;
+    void visit(const IfStmt& stmt) override;
+    void visit(const PrintStmt& stmt) override;
+    void visit(const ReturnStmt& stmt) override;
+    void visit(const BreakStmt& stmt) override;
+    void visit(const ContinueStmt& stmt) override;
+    void visit(const VarStmt& stmt) override;
+    void visit(const WhileStmt& stmt) override;
+    void visit(const ForStmt& stmt) override;
+
+private:
+    struct Local {
+        Symbol name;
+        int depth;
+        bool is_captured = false;
+    };
+
+    struct Upvalue {
+        uint16_t index;
+        bool is_local;
+    };
+
+    struct Loop {
+        int scope_depth;
+        size_t continue_target;               // Backward target, or npos when patched later.
+        std::vector<size_t> continue_jumps;
+        std::vector<size_t> break_jumps;
+    };
+
+    struct FunctionState {
+        FunctionState* enclosing;
+        std::shared_ptr<CompiledFunction> function;
+        std::vector<Local> locals;
+        std::vector<Upvalue> upvalues;
+        std::vector<Loop> loops;
+        int scope_depth = 0;
+        // Constant index of every name the chunk refers to, so each is stored once.
+        std::unordered_map<Symbol, size_t> identifiers;
+        bool constants_exhausted = false;
+    };
+
+    FunctionState* current = nullptr;
+    unsigned int line = 1;
+
+    Chunk& chunk();
+    void compile(const Stmt& stmt);
+    void compile(const Expr& expr);
+    void compileFunction(const FnStmt& stmt);
+    void compileCall(const CallExpr& expr, OpCode op);
+
+    void emit(OpCode op);
+    void emitByte(uint8_t byte);
+    void emitShort(size_t value);
+    void emitConstant(Value value);
+    size_t makeConstant(Value value);
+    size_t identifierConstant(const Token& identifier);
+    size_t emitJump(OpCode op);
+    void patchJump(size_t offset);
+    void emitLoop(size_t loop_start);
+
+    void beginScope();
+    void endScope();
+    void discardLocals(int depth);
+    void declareLocal(const Token& identifier);
+    void markInitialized();
+    void defineVariable(const Token& identifier);
+    int resolveLocal(FunctionState& state, Symbol name);
+    int resolveUpvalue(FunctionState& state, Symbol name);
+    int addUpvalue(FunctionState& state, uint16_t index, bool is_local);
+    void namedVariable(const Token& identifier, bool assign);
+
+    void error(const std::string& message);
+};
+
+#endif // COMPILER_HPP
@@ -1,33 +1,62 @@
-
 #ifndef ENVIRONMENT_HPP
 #define ENVIRONMENT_HPP
 
 #include "../include/Typedef.hpp"
 #include "ListType.hpp"
 #include "RuntimeError.hpp"
+#include "Symbol.hpp"
 #include "Token.hpp"
-#include <any>
+#include "Value.hpp"
 #include <cassert>
 #include <memory>
 #include <unordered_map>
+#include <vector>
+
+// Storage of a local that a closure captures. The declaring frame and every closure share the
+// cell, so an assignment on either side is seen by the other.
+class Cell : public Object {
+public:
+    explicit Cell(Value value) : value{std::move(value)} {}
+    std::string toString() const override { return value.toString(); }
 
+    Value value;
+};
+
+// A frame holds the locals of one function call (or one top-level block) in the slots the Resolver
+// assigned to them; nested blocks occupy a range at the end and truncate it when they are left.
+// Only the global environment keeps its variables by name.
 class Environment {
 public:
-    explicit Environment(std::shared_ptr<Environment> parent_env);
-    Environment();
 
-    void define(const std::string& identifier, const std::any& value);
-    void define(const std::string& identifier, shared_ptr_any ptr_to_val);
-    void assign(const Token& identifier, const std::any& value);
-    void assignAt(size_t distance, const Token& identifier, const std::any& value);
+    // Globals.
+    void define(Symbol identifier, const Value& value);
+    void assign(const Token& identifier, const Value& value);
+    Value& lookup(const Token& identifier);
+
+    // Locals, defined in slot order.
+    void define(const Value& value);
+    void defineCell(const Value& value);
+    Value& at(size_t slot) { return slots[slot]; }
+    size_t size() const { return slots.size(); }
+    void truncate(size_t size);
 
-    shared_ptr_any lookup(const Token& identifier);
-    shared_ptr_any getAt(size_t distance, const std::string& identifier);
-    Environment* ancestor(size_t distance);
+private:
+    friend class EnvironmentPool;
+
+    std::vector<Value> slots;
+    std::unordered_map<Symbol, Value> values;
+};
+
+// Recycles local frames. Closures capture cells rather than frames, so a frame is never used once
+// its scope has been left and can be handed out again, keeping the storage of its slots.
+class EnvironmentPool {
+public:
+    Environment* acquire();
+    void release(Environment* environment);
 
 private:
-    std::shared_ptr<Environment> parent_env;
-    std::unordered_map<std::string, shared_ptr_any> values;
+    std::vector<std::unique_ptr<Environment>> environments;
+    std::vector<Environment*> free_list;
 };
 
-#endif // ENVIRONMENT_HPP
\ No newline at end of file
+#endif // ENVIRONMENT_HPP
@@ -4,23 +4,74 @@
 #include "Token.hpp"
 #include "Typedef.hpp"
 #include "Visitor.hpp"
+#include <cstdint>
 #include <vector>
 
+class Callable;
+
+// Where a variable reference was found by the Resolver. Locals are addressed by their slot in the
+// frame of the running function, globals by name. Locals that a closure captures
+// live in a Cell inside their slot, and inside the closure they are reached through the upvalue
+// with index 'slot'.
+struct VariableLocation {
+    enum class Kind : uint8_t {
+        GLOBAL,
+        LOCAL,
+        CELL,
+        UPVALUE
+    };
+
+    Kind kind = Kind::GLOBAL;
+    uint32_t slot = 0u;
+};
+
 struct AssignExpr : Expr {
     Token identifier;
     unique_expr_ptr value;
+    mutable VariableLocation location;
 
     AssignExpr(Token identifier, unique_expr_ptr value);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct BinaryExpr : Expr {
+    // The specialized form the interpreter rewrote the node into after its first evaluation,
+    // guarded by the operand types seen then. Once a guard fails the node stays GENERIC.
+    enum class Quickened : uint8_t {
+        UNSEEN,
+        GENERIC,
+        ADD_NUMBERS,
+        SUBTRACT_NUMBERS,
+        MULTIPLY_NUMBERS,
+        DIVIDE_NUMBERS,
+        LESS_NUMBERS,
+        LESS_EQUAL_NUMBERS,
+        GREATER_NUMBERS,
+        GREATER_EQUAL_NUMBERS,
+        EQUAL_NUMBERS,
+        NOT_EQUAL_NUMBERS,
+        ADD_STRINGS
+    };
+
+    // Literal and variable operands are read in place rather than evaluated and copied. The left
+    // one only if the right one cannot run code that changes it.
+    enum class Operand : uint8_t {
+        EXPRESSION,
+        LITERAL,
+        VARIABLE
+    };
+
     unique_expr_ptr left;
     Token op;
     unique_expr_ptr right;
+    mutable Quickened quickened = Quickened::UNSEEN;
+    mutable Operand left_operand = Operand::EXPRESSION;
+    mutable Operand right_operand = Operand::EXPRESSION;
 
     BinaryExpr(unique_expr_ptr left, Token op, unique_expr_ptr right);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct UnaryExpr : Expr {
@@ -29,6 +80,7 @@ struct UnaryExpr : Expr {
 
     UnaryExpr(Token op, unique_expr_ptr right);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct IncrementExpr : Expr {
@@ -39,8 +91,10 @@ struct IncrementExpr : Expr {
 
     Token identifier;
     Type type;
+    mutable VariableLocation location;
     IncrementExpr(Token identifier, Type type);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct DecrementExpr : Expr {
@@ -51,17 +105,25 @@ struct DecrementExpr : Expr {
 
     Token identifier;
     Type type;
+    mutable VariableLocation location;
     DecrementExpr(Token identifier, Type type);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct CallExpr : Expr {
     unique_expr_ptr callee;
     Token paren;
     std::vector<unique_expr_ptr> args;
+    // The last callable seen at this call site once it passed the arity check, and its arity.
+    // The site does not keep it alive: a callable allocated later at the same address only skips
+    // the check if it takes the same number of arguments.
+    mutable const Callable* cached_callee = nullptr;
+    mutable size_t cached_arity = 0u;
 
     CallExpr(unique_expr_ptr callee, Token paren, std::vector<unique_expr_ptr> args);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct GetExpr : Expr {
@@ -70,6 +132,7 @@ struct GetExpr : Expr {
 
     GetExpr(unique_expr_ptr object, Token identifier);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct SetExpr : Expr {
@@ -79,6 +142,7 @@ struct SetExpr : Expr {
 
     SetExpr(unique_expr_ptr object, Token identifier, unique_expr_ptr value);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct GroupingExpr : Expr {
@@ -86,13 +150,15 @@ struct GroupingExpr : Expr {
 
     explicit GroupingExpr(unique_expr_ptr expression);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct LiteralExpr : Expr {
-    std::any literal;
+    Value literal;
 
-    explicit LiteralExpr(std::any literal);
+    explicit LiteralExpr(Value literal);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct LogicalExpr : Expr {
@@ -102,6 +168,7 @@ struct LogicalExpr : Expr {
 
     LogicalExpr(unique_expr_ptr left, Token op, unique_expr_ptr right);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct SuperExpr : Expr {
@@ -110,6 +177,7 @@ struct SuperExpr : Expr {
 
     SuperExpr(Token keyword, Token method);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct ThisExpr : Expr {
@@ -117,13 +185,16 @@ struct ThisExpr : Expr {
 
     explicit ThisExpr(Token keyword);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct VarExpr : Expr {
     Token identifier;
+    mutable VariableLocation location;
 
     explicit VarExpr(Token identifier);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct ListExpr : Expr {
@@ -132,15 +203,18 @@ struct ListExpr : Expr {
 
     ListExpr(Token opening_bracket, std::vector<unique_expr_ptr> items);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 struct SubscriptExpr : Expr {
     Token identifier;
     unique_expr_ptr index;
     unique_expr_ptr value;
+    mutable VariableLocation location;
 
     SubscriptExpr(Token identifier, unique_expr_ptr index, unique_expr_ptr value);
     std::any accept(ExprVisitor<std::any>& visitor) const override;
+    Value accept(ExprVisitor<Value>& visitor) const override;
 };
 
 #endif // EXPR_HPP
\ No newline at end of file
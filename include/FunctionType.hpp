@@ -1,25 +1,38 @@
-
 #ifndef FUNCTION_TYPE_HPP
 #define FUNCTION_TYPE_HPP
 
 #include "Callable.hpp"
 #include "Interpreter.hpp"
-#include <memory>
+#include <unordered_map>
+#include <vector>
 
 struct FnStmt;
 
 class FunctionType : public Callable {
 public:
-    FunctionType(const FnStmt* declaration, std::shared_ptr<Environment> closure);
+    FunctionType(const FnStmt* declaration, std::vector<Value> upvalues);
 
     size_t getArity() const override;
-    std::any call(Interpreter& interpreter, const std::vector<std::any>& args) const override;
+    const FnStmt& getDeclaration() const { return *declaration; }
+    std::span<const Value> getUpvalues() const { return upvalues; }
+    Value call(Interpreter& interpreter, std::span<const Value> args) const override;
     std::string toString() const override;
 
 private:
-    size_t arity = 0u;
+    // Memo keys tell integers from doubles and compare doubles by their bits, so 0 and -0 stay apart.
+    struct ArgumentsHash {
+        using is_transparent = void;
+        size_t operator()(std::span<const Value> args) const noexcept;
+    };
+    struct ArgumentsEqual {
+        using is_transparent = void;
+        bool operator()(std::span<const Value> lhs, std::span<const Value> rhs) const noexcept;
+    };
+
     const FnStmt* declaration;
-    std::shared_ptr<Environment> closure;
+    std::vector<Value> upvalues;
+    // Results of a pure function by arguments, up to the interpreter's memo limit.
+    mutable std::unordered_map<std::vector<Value>, Value, ArgumentsHash, ArgumentsEqual> memo;
 };
 
-#endif // FUNCTION_TYPE_HPP
\ No newline at end of file
+#endif // FUNCTION_TYPE_HPP
@@ -2,38 +2,46 @@
 #ifndef INTERPRETER_HPP
 #define INTERPRETER_HPP
 
+#include "ArrayType.hpp"
 #include "Callable.hpp"
 #include "Environment.hpp"
 #include "ExprNode.hpp"
+#include "Jit.hpp"
 #include "RuntimeError.hpp"
 #include "StmtNode.hpp"
 #include "Visitor.hpp"
-#include <unordered_map>
+#include <span>
 
-class Interpreter : public ExprVisitor<std::any>, public StmtVisitor {
+class Interpreter : public ExprVisitor<Value>, public StmtVisitor {
 public:
-    Interpreter();
+    // Results remembered per pure function unless configured otherwise.
+    static constexpr size_t default_memo_limit = 65536u;
+
+    explicit Interpreter(bool jit = true, size_t memo_limit = default_memo_limit);
 
     void interpret(const std::vector<unique_stmt_ptr>& statements);
-    void executeBlock(const std::vector<unique_stmt_ptr>& statements, std::shared_ptr<Environment> enclosing_env);
-    void resolve(const Expr& expr_ptr, size_t depth);
+    void executeBlock(const std::vector<unique_stmt_ptr>& statements, Environment* frame);
+    Value executeFunction(const FnStmt& declaration, std::span<const Value> args, std::span<const Value> captured);
+    size_t memoLimit() const { return memo_limit; }
+    // Whether the JIT has machine code for 'function'.
+    bool isCompiled(const FnStmt& function) const;
 
-    std::any visit(const BinaryExpr& expr) override;
-    std::any visit(const UnaryExpr& expr) override;
-    std::any visit(const GroupingExpr& expr) override;
-    std::any visit(const LiteralExpr& expr) override;
-    std::any visit(const AssignExpr& expr) override;
-    std::any visit(const CallExpr& expr) override;
-    std::any visit(const SetExpr& expr) override;
-    std::any visit(const GetExpr& expr) override;
-    std::any visit(const SuperExpr& expr) override;
-    std::any visit(const LogicalExpr& expr) override;
-    std::any visit(const ThisExpr& expr) override;
-    std::any visit(const VarExpr& expr) override;
-    std::any visit(const ListExpr& expr) override;
-    std::any visit(const SubscriptExpr& expr) override;
-    std::any visit(const IncrementExpr& expr) override;
-    std::any visit(const DecrementExpr& expr) override;
+    Value visit(const BinaryExpr& expr) override;
+    Value visit(const UnaryExpr& expr) override;
+    Value visit(const GroupingExpr& expr) override;
+    Value visit(const LiteralExpr& expr) override;
+    Value visit(const AssignExpr& expr) override;
+    Value visit(const CallExpr& expr) override;
+    Value visit(const SetExpr& expr) override;
+    Value visit(const GetExpr& expr) override;
+    Value visit(const SuperExpr& expr) override;
+    Value visit(const LogicalExpr& expr) override;
+    Value visit(const ThisExpr& expr) override;
+    Value visit(const VarExpr& expr) override;
+    Value visit(const ListExpr& expr) override;
+    Value visit(const SubscriptExpr& expr) override;
+    Value visit(const IncrementExpr& expr) override;
+    Value visit(const DecrementExpr& expr) override;
 
     void visit(const BlockStmt& stmt) override;
     void visit(const ClassStmt& stmt) override;
@@ -50,28 +58,69 @@ public:
 
     class EnvironmentGuard {
     public:
-        EnvironmentGuard(Interpreter& interpreter, std::shared_ptr<Environment> env);
+        EnvironmentGuard(Interpreter& interpreter, Environment* frame);
         ~EnvironmentGuard();
 
     private:
         Interpreter& interpreter;
-        std::shared_ptr<Environment> previous_env;
+        Environment* previous_env;
+    };
+
+    class SlotGuard {
+    public:
+        explicit SlotGuard(Environment& frame);
+        ~SlotGuard();
+
+    private:
+        Environment& frame;
+        size_t size;
     };
 
 private:
+    // How the last executed statement finished. Anything but NORMAL unwinds the enclosing blocks
+    // until a loop (BREAK/CONTINUE) or a function call (RETURN) consumes it.
+    enum class Completion {
+        NORMAL,
+        BREAK,
+        CONTINUE,
+        RETURN
+    };
+
+    Completion completion = Completion::NORMAL;
+    Value return_value;
+    // Function a call in tail position returns into instead of calling it; its arguments are left
+    // on top of 'arguments'.
+    Value tail_callee;
     std::unique_ptr<Environment> globals = std::make_unique<Environment>();
     Environment* const global_environment;
-    std::shared_ptr<Environment> environment;
-    std::unordered_map<const Expr*, size_t> locals;
+    Environment* environment;
+    EnvironmentPool frames;
+    // Cells captured by the function being executed.
+    std::span<const Value> upvalues;
+    // Arguments of the calls in progress; each call pushes its own on top and pops them after.
+    std::vector<Value> arguments;
+    // Compiles hot numeric functions; null when the JIT is disabled.
+    std::unique_ptr<Jit> jit;
+    size_t memo_limit;
 
-    void checkNumberOperand(const Token& op, const std::any& operand) const;
-    void checkNumberOperands(const Token& op, const std::any& lhs, const std::any& rhs) const;
-    bool isTruthy(const std::any& object) const;
-    bool isEqual(const std::any& lhs, const std::any& rhs) const;
-    std::any evaluate(const Expr& expr);
+    void checkNumberOperand(const Token& op, const Value& operand) const;
+    void checkNumberOperands(const Token& op, const Value& lhs, const Value& rhs) const;
+    Value evaluate(const Expr& expr);
     void execute(const Stmt& stmt);
-    shared_ptr_any lookUpVariable(const Token& identifier, const Expr* expr_ptr) const;
-    void assignVariable(const Expr* expr_ptr, const Token& identifier, const std::any& value);
+    void executeStatements(const std::vector<unique_stmt_ptr>& statements);
+    template <typename Body>
+    void executeScope(ScopeLayout layout, Body&& body);
+    bool executeLoopBody(const Stmt& body);
+    bool executeCountedLoop(const ForStmt::CountedLoop& loop, const Stmt& body);
+    bool executeNative(const FnStmt& function, std::span<const Value> args, Value& result);
+    Value prepareCall(const CallExpr& expr);
+    Value invoke(const CallExpr& expr, const Value& callee, std::span<const Value> args);
+    const Value& operand(const Expr& expr, BinaryExpr::Operand kind, Value& storage);
+    Value evaluateBinary(const BinaryExpr& expr, const Value& left, const Value& right);
+    Value evaluateArrays(const Token& op, ArrayOperation operation, const Value& left, const Value& right) const;
+    Value& lookUpVariable(const Token& identifier, const VariableLocation& location) const;
+    void assignVariable(const VariableLocation& location, const Token& identifier, const Value& value);
+    void defineVariable(const Token& identifier, const VariableLocation& location, const Value& value);
 };
 
 #endif // INTERPRETER_HPP
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef JIT_HPP
+#define JIT_HPP
+
+#include "StmtNode.hpp"
+#include "Value.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Baseline compiler from hot missions to x86-64 machine code, used by the tree-walker on Linux.
+// Only missions that compute with integers alone are compiled: integer literals, parameters and
+// locals, arithmetic, comparisons in conditions, control flow and calls to the mission itself.
+// compile() returns nullptr for anything else and the mission stays interpreted. The code
+// computes in doubles and only runs on integer arguments; a result the interpreter would hold as
+// a double (a fraction, -0 or 2^53 and beyond) fails a guard.
+//
+// Compiled code has no effects outside its own frames, so rather than deoptimizing in the middle
+// of a call it gives up on the whole call: a failing guard makes run() return false and the
+// interpreter starts the call over.
+class Jit {
+public:
+    using NativeFunction = double (*)(const double* args);
+
+    // Calls a mission takes before it is compiled.
+    static constexpr uint32_t threshold = 64u;
+
+    // What the JIT knows about one mission: its calls, counted until it is compiled, and then its
+    // machine code. Kept here rather than in the AST, which other interpreters may run as well.
+    struct Entry {
+        uint32_t calls = 0u;
+        NativeFunction code = nullptr;
+    };
+
+    Jit();
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+    ~Jit();
+
+    // 'binding' is the global variable holding the mission; calls to itself check it still does.
+    // Without 'self_calls' only tail calls to itself are compiled, so that a mission whose results
+    // are memoized recurses through the interpreter and its memo.
+    NativeFunction compile(const FnStmt& function, const Value& binding, bool self_calls);
+    // Runs 'code' on arguments that are all integers below 2^53 in magnitude.
+    bool run(NativeFunction code, std::span<const Value> args, double& result);
+    Entry& entry(const FnStmt& function) { return entries[&function]; }
+    bool compiled(const FnStmt& function) const;
+
+private:
+    // Shared with the generated code through absolute addresses.
+    struct Runtime {
+        uint64_t bailed = 0u;
+        uint64_t depth = 0u;
+    };
+
+    std::unique_ptr<Runtime> runtime;
+    std::vector<std::pair<void*, size_t>> regions;
+    // Compiled code compares against the address of its mission, which must not be reused.
+    std::vector<Value> functions;
+    std::unordered_map<const FnStmt*, Entry> entries;
+};
+
+#endif // JIT_HPP
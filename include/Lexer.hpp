@@ -1,19 +1,27 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
 
+#include "Symbol.hpp"
 #include "Token.hpp"
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+// Tokens point into 'source', which the caller keeps alive for as long as they are used. The
+// Parser pulls tokens one at a time with nextToken(); scanTokens() lexes everything up front.
 class Lexer {
 public:
-    explicit Lexer(std::string source);
+    explicit Lexer(std::string_view source);
+    Token nextToken();
     std::vector<Token> scanTokens();
-    static const std::unordered_map<std::string, TokenType> keywords;
+    static const std::unordered_map<Symbol, TokenType> keywords;
 
 private:
-    const std::string source;
-    std::vector<Token> tokens;
+    const std::string_view source;
+    // Offset of the start of 'source' among all source texts.
+    const uint32_t first;
+    std::optional<Token> scanned;
     unsigned int start = 0;
     unsigned int current = 0;
     unsigned int line = 1;
@@ -23,11 +31,11 @@ private:
     bool isAlpha(char c) const;
     bool isAlphaNumeric(char c) const;
     bool match(char expected);
-    std::string getLexeme(TokenType type) const;
+    std::string_view getLexeme(TokenType type) const;
     void advance();
     char peek() const;
     char peekNext() const;
-    void addToken(TokenType type);
+    void addToken(TokenType type, Symbol symbol = Symbols::none);
     void scanToken();
     void string();
     void number();
@@ -1,21 +1,27 @@
+#ifndef LIST_TYPE_HPP
+#define LIST_TYPE_HPP
 
+#include "Value.hpp"
 #include <algorithm>
-#include <any>
 #include <stdexcept>
 #include <vector>
 
-class List {
+class List : public Object {
 public:
     List() = default;
 
-    explicit List(std::vector<std::any> values);
+    explicit List(std::vector<Value> values);
     size_t length() const noexcept;
-    std::any& at(int index);
-    void append(const std::any& value);
-    std::any pop() noexcept;
+    Value& at(int index);
+    void append(const Value& value);
+    Value pop() noexcept;
     void remove(int index);
+    std::string toString() const override;
+    void appendTo(std::string& out) const override;
 
 private:
-    std::vector<std::any> values;
+    std::vector<Value> values;
     size_t len = 0u;
 };
+
+#endif // LIST_TYPE_HPP
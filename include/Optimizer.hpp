@@ -0,0 +1,58 @@
+#ifndef OPTIMIZER_HPP
+#define OPTIMIZER_HPP
+
+#include "ExprNode.hpp"
+#include "StmtNode.hpp"
+#include "Symbol.hpp"
+#include "Visitor.hpp"
+#include <vector>
+
+// Rewrites a parsed program before it is resolved: folds operations on literals, drops grouping
+// parentheses, removes identity operations and marks numeric for loops as counted loops. Nothing
+// is folded that could fail at runtime, so errors are still reported where and when the
+// unoptimized program would report them.
+//
+// Each expression visit returns the node that replaces the visited one, or nothing to keep it.
+class Optimizer : public ExprVisitor<std::any>, public StmtVisitor {
+public:
+    void optimize(std::vector<unique_stmt_ptr>& statements);
+
+    std::any visit(const BinaryExpr& expr) override;
+    std::any visit(const UnaryExpr& expr) override;
+    std::any visit(const GroupingExpr& expr) override;
+    std::any visit(const LiteralExpr& expr) override;
+    std::any visit(const AssignExpr& expr) override;
+    std::any visit(const CallExpr& expr) override;
+    std::any visit(const SetExpr& expr) override;
+    std::any visit(const GetExpr& expr) override;
+    std::any visit(const SuperExpr& expr) override;
+    std::any visit(const LogicalExpr& expr) override;
+    std::any visit(const ThisExpr& expr) override;
+    std::any visit(const VarExpr& expr) override;
+    std::any visit(const ListExpr& expr) override;
+    std::any visit(const SubscriptExpr& expr) override;
+    std::any visit(const IncrementExpr& expr) override;
+    std::any visit(const DecrementExpr& expr) override;
+
+    void visit(const BlockStmt& stmt) override;
+    void visit(const ClassStmt& stmt) override;
+    void visit(const ExprStmt& stmt) override;
+    void visit(const FnStmt& stmt) override;
+    void visit(const IfStmt& stmt) override;
+    void visit(const PrintStmt& stmt) override;
+    void visit(const ReturnStmt& stmt) override;
+    void visit(const BreakStmt& stmt) override;
+    void visit(const ContinueStmt& stmt) override;
+    void visit(const VarStmt& stmt) override;
+    void visit(const WhileStmt& stmt) override;
+    void visit(const ForStmt& stmt) override;
+
+private:
+    // Every variable assigned so far, in visiting order, to tell which ones a loop body modifies.
+    std::vector<Symbol> assigned;
+
+    void optimize(const unique_stmt_ptr& stmt);
+    void optimize(const unique_expr_ptr& expr);
+};
+
+#endif // OPTIMIZER_HPP
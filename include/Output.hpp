@@ -0,0 +1,38 @@
+#ifndef OUTPUT_HPP
+#define OUTPUT_HPP
+
+#include "Value.hpp"
+#include <string>
+
+// Buffer in front of standard output shared by both engines. Values are formatted straight into
+// it, and it is written out according to the flush policy, when flush() is called and at exit.
+class Output {
+public:
+    enum class FlushPolicy {
+        LINE,     // after every line, for terminals
+        SIZE,     // whenever 'capacity' bytes are waiting
+        EXPLICIT  // only when asked to
+    };
+
+    static constexpr size_t capacity = 64u * 1024u;
+
+    static Output& standard();
+
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+    ~Output();
+
+    void setPolicy(FlushPolicy policy);
+    void append(const Value& value);
+    void append(char character);
+    void endLine();
+    void flush();
+
+private:
+    Output();
+
+    std::string buffer;
+    FlushPolicy policy = FlushPolicy::SIZE;
+};
+
+#endif // OUTPUT_HPP
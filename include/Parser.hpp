@@ -2,7 +2,9 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include "Arena.hpp"
 #include "ExprNode.hpp"
+#include "Lexer.hpp"
 #include "Logger.hpp"
 #include "StmtNode.hpp"
 #include "Token.hpp"
@@ -12,14 +14,30 @@
 #include <stdexcept>
 #include <vector>
 
+// The statements of a parsed program together with the arena all of its nodes live in. The
+// statements are declared last so they are destroyed before their memory goes away.
+struct Program {
+    std::unique_ptr<Arena> arena;
+    std::vector<unique_stmt_ptr> statements;
+};
+
+// Pulls tokens from the Lexer on demand. The grammar needs one token of lookahead, so only the
+// current and the previous token are kept.
 class Parser {
 public:
-    explicit Parser(std::vector<Token> tokens);
-    std::vector<unique_stmt_ptr> parse();
+    explicit Parser(Lexer& lexer);
+    Program parse();
 
 private:
-    std::vector<Token> tokens;
-    unsigned int current = 0;
+    Lexer& lexer;
+    Token current;
+    Token previous_token;
+    std::unique_ptr<Arena> arena = std::make_unique<Arena>();
+
+    template <typename T, typename... Args>
+    unique_node_ptr<T> make(Args&&... args) {
+        return unique_node_ptr<T>{arena->create<T>(std::forward<Args>(args)...)};
+    }
 
     unique_stmt_ptr declaration();
     unique_stmt_ptr classDecl();
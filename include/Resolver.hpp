@@ -3,15 +3,15 @@
 #ifndef RESOLVER_HPP
 #define RESOLVER_HPP
 
-#include "Interpreter.hpp"
+#include "ExprNode.hpp"
+#include "StmtNode.hpp"
 #include "Visitor.hpp"
-#include <stack>
 #include <unordered_map>
 #include <vector>
 
 class Resolver : public ExprVisitor<std::any>, public StmtVisitor {
 public:
-    explicit Resolver(Interpreter& interpreter);
+    Resolver();
     void resolve(const std::vector<unique_stmt_ptr>& statements);
     enum class FuncType {
         NONE,
@@ -49,19 +49,50 @@ public:
     void visit(const ForStmt& stmt) override;
 
 private:
-    Interpreter& interpreter;
-    using Scope = std::unordered_map<std::string, bool>;
+    struct Variable {
+        bool defined;
+        bool captured;
+        uint32_t slot;
+        // The declaration and every reference from the declaring function, patched to CELL
+        // once a closure captures the variable.
+        std::vector<VariableLocation*> uses;
+    };
+
+    struct FunctionScope {
+        FuncType type;
+        const FnStmt* declaration; // nullptr for top-level code
+        size_t scope_base;          // Index of the function's outermost scope in 'scopes'.
+        std::vector<const Variable*> upvalues;
+        uint32_t slot_count;        // Slots in use in the frame of the innermost scope.
+        bool has_frame;             // Top-level code only has a frame inside a FRAME scope.
+        // Whether the body has no effects besides its result so far, and the globals it reads.
+        bool pure;
+        std::vector<Symbol> global_reads;
+    };
+
+    using Scope = std::unordered_map<Symbol, Variable>;
     std::vector<Scope> scopes;
-    std::stack<FuncType> func_stack;
+    std::vector<FunctionScope> functions;
     size_t loop_nesting_level = 0u;
+    // How often each global is declared or assigned, and the functions that are pure as long as
+    // the globals they read are pure functions bound only once.
+    std::unordered_map<Symbol, uint32_t> global_bindings;
+    std::vector<std::pair<const FnStmt*, std::vector<Symbol>>> pure_candidates;
 
     void resolve(const Stmt& stmt);
     void resolve(const Expr& expr);
-    void resolveLocal(const Expr* expr, const Token& name);
+    void resolveLocal(VariableLocation& location, const Token& name);
+    uint32_t resolveUpvalue(size_t function, size_t scope, Variable& variable);
+    void capture(Variable& variable);
     void resolveFunction(const FnStmt& stmt, FuncType type);
+    void resolvePurity();
+    void markImpure();
+    void recordGlobalAssignment(const VariableLocation& location, const Token& identifier);
     void beginScope();
     void endScope();
-    void declare(const Token& identifier);
+    ScopeLayout beginBlockScope(bool declares);
+    void endBlockScope(ScopeLayout layout);
+    void declare(const Token& identifier, VariableLocation& location);
     void define(const Token& identifer);
 };
 
@@ -16,4 +16,11 @@ private:
     Token token;
 };
 
+// Raised by code that has no token at hand, such as built-in functions. The engine reports it as a
+// RuntimeError at the line it is running.
+class NativeError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
 #endif // RUNTIME_ERROR_HPP
\ No newline at end of file
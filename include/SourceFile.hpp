@@ -0,0 +1,28 @@
+#ifndef SOURCE_FILE_HPP
+#define SOURCE_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// The text of a script. Regular files are memory mapped and lexed in place; anything that
+// cannot be mapped, such as a pipe or standard input ("-"), is read into a buffer instead.
+// Throws std::system_error if the file cannot be read.
+class SourceFile {
+public:
+    explicit SourceFile(const std::string& path);
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    ~SourceFile();
+
+    std::string_view text() const noexcept;
+
+private:
+    void* mapping = nullptr;
+    size_t mapping_size = 0u;
+    std::string buffer;
+
+    void readAll(int fd);
+};
+
+#endif // SOURCE_FILE_HPP
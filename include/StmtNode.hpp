@@ -5,10 +5,20 @@
 #include "Token.hpp"
 #include "Typedef.hpp"
 #include "Visitor.hpp"
+#include <optional>
 #include <vector>
 
+// How the Resolver laid out the variables of a block or for loop. Scopes are flattened into the
+// frame they are nested in, so only a top-level scope that declares something needs its own.
+enum class ScopeLayout : uint8_t {
+    NONE,  // Declares nothing; runs in the enclosing frame as is.
+    SLOTS, // Appends its variables to the enclosing frame and drops them on exit.
+    FRAME  // Top-level scope with variables; gets a frame of its own.
+};
+
 struct BlockStmt : Stmt {
     std::vector<unique_stmt_ptr> statements;
+    mutable ScopeLayout layout = ScopeLayout::NONE;
 
     explicit BlockStmt(std::vector<unique_stmt_ptr> statements);
     void accept(StmtVisitor& visitor) const override;
@@ -16,10 +26,10 @@ struct BlockStmt : Stmt {
 
 struct ClassStmt : Stmt {
     Token identifier;
-    std::unique_ptr<VarExpr> superclass; // OPTIONAL
-    std::vector<std::unique_ptr<FnStmt>> methods;
+    unique_node_ptr<VarExpr> superclass; // OPTIONAL
+    std::vector<unique_node_ptr<FnStmt>> methods;
 
-    ClassStmt(Token identifier, std::vector<std::unique_ptr<FnStmt>> methods, std::unique_ptr<VarExpr> superclass);
+    ClassStmt(Token identifier, std::vector<unique_node_ptr<FnStmt>> methods, unique_node_ptr<VarExpr> superclass);
     void accept(StmtVisitor& visitor) const override;
 };
 
@@ -34,6 +44,12 @@ struct FnStmt : Stmt {
     Token identifier;
     std::vector<Token> params;
     std::vector<unique_stmt_ptr> body;
+    mutable VariableLocation location;
+    mutable std::vector<VariableLocation> param_locations;
+    // Where each upvalue is taken from when the function is declared, in upvalue order.
+    mutable std::vector<VariableLocation> captures;
+    // Set by the Resolver when calls can be answered from earlier results with the same arguments.
+    mutable bool pure = false;
 
     FnStmt(Token identifier, std::vector<Token> params, std::vector<unique_stmt_ptr> body);
     void accept(StmtVisitor& visitor) const override;
@@ -65,6 +81,8 @@ struct PrintStmt : Stmt {
 struct ReturnStmt : Stmt {
     Token keyword;
     unique_expr_ptr expression; // OPTIONAL
+    // Set by the Resolver when the returned expression is a call made from inside a function.
+    mutable bool tail_call = false;
 
     ReturnStmt(Token keyword, unique_expr_ptr expr);
     void accept(StmtVisitor& visitor) const override;
@@ -87,6 +105,7 @@ struct BreakStmt : Stmt {
 struct VarStmt : Stmt {
     Token identifier;
     unique_expr_ptr initializer; // OPTIONAL
+    mutable VariableLocation location;
 
     VarStmt(Token identifier, unique_expr_ptr initializer);
     void accept(StmtVisitor& visitor) const override;
@@ -105,6 +124,16 @@ struct ForStmt : Stmt {
     unique_expr_ptr condition;
     unique_expr_ptr increment;
     unique_stmt_ptr body;
+    mutable ScopeLayout layout = ScopeLayout::NONE;
+
+    // Set by the Optimizer for loops shaped like 'navigate (atom i = a; i < n; i++)' whose body never
+    // assigns 'i', so the counter can be kept outside the variable.
+    struct CountedLoop {
+        const VarStmt* counter;
+        const BinaryExpr* condition; // 'i' compared against a limit that is evaluated every time
+        int64_t step;
+    };
+    mutable std::optional<CountedLoop> counted;
 
     ForStmt(unique_stmt_ptr initializer, unique_expr_ptr condition, unique_expr_ptr increment, unique_stmt_ptr body);
     void accept(StmtVisitor& visitor) const override;
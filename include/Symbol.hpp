@@ -0,0 +1,19 @@
+#ifndef SYMBOL_HPP
+#define SYMBOL_HPP
+
+#include <cstdint>
+#include <string_view>
+
+// Identifiers are interned once by the Lexer. Everything downstream hashes and compares the
+// resulting id instead of the name.
+using Symbol = uint32_t;
+
+namespace Symbols {
+    // The symbol of the empty name, carried by tokens that are not identifiers.
+    constexpr Symbol none = 0u;
+
+    Symbol intern(std::string_view name);
+    std::string_view name(Symbol symbol);
+}
+
+#endif // SYMBOL_HPP
@@ -1,8 +1,11 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
-#include <string>
+#include "Symbol.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
 
-enum class TokenType
+enum class TokenType : uint8_t
 {
     // Single-character tokens
     LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
@@ -22,16 +25,34 @@ enum class TokenType
     _EOF
 };
 
+// Source texts that tokens point into. Each text added gets its own range of 32-bit offsets, so
+// a token can name its lexeme by offset. Texts have to outlive every token and every AST node
+// built from them.
+namespace Sources {
+    // Returns the offset of the first character of 'text'.
+    uint32_t add(std::string_view text);
+    std::string_view slice(uint32_t offset, uint32_t length);
+}
+
+// A token refers to its lexeme inside the source text instead of owning a copy.
 struct Token {
-    Token(TokenType type, std::string lexeme, unsigned int line);
-    Token(Token&& token) noexcept;
-    Token(const Token& token);
+    // Lines past this one are reported as this one.
+    static constexpr uint32_t max_line = (1u << 24) - 1u;
+
+    Token(TokenType type, uint32_t offset, uint32_t length, unsigned int line, Symbol symbol = Symbols::none) noexcept;
 
-    const TokenType type;
-    std::string lexeme;
-    const unsigned int line;
+    std::string_view lexeme() const noexcept { return Sources::slice(offset, length); }
+
+    uint32_t offset;
+    uint32_t length;
+    uint32_t line : 24;
+    TokenType type;
+    // Interned name of identifiers and keywords.
+    Symbol symbol;
 };
 
+static_assert(sizeof(Token) == 16u);
+
 std::ostream& operator<<(std::ostream& os, const Token& token);
 std::ostream& operator<<(std::ostream& os, const TokenType type);
 
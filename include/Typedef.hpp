@@ -1,14 +1,40 @@
 #ifndef TYPEDEF_HPP
 #define TYPEDEF_HPP
 
-#include <any>
+#include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 struct Expr;
 struct Stmt;
 
-using unique_expr_ptr = std::unique_ptr<Expr>;
-using unique_stmt_ptr = std::unique_ptr<Stmt>;
-using shared_ptr_any = std::shared_ptr<std::any>;
+// Nodes live in the Arena of the program they were parsed into, so owning pointers only run
+// the destructor and leave the memory to the arena.
+struct NodeDeleter {
+    template <typename T>
+    void operator()(T* node) const noexcept {
+        node->~T();
+    }
+};
 
-#endif // TYPEDEF_HPP
\ No newline at end of file
+template <typename T>
+using unique_node_ptr = std::unique_ptr<T, NodeDeleter>;
+
+using unique_expr_ptr = unique_node_ptr<Expr>;
+using unique_stmt_ptr = unique_node_ptr<Stmt>;
+
+// Lets string keyed maps be probed with a lexeme without building a std::string first.
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view string) const noexcept {
+        return std::hash<std::string_view>{}(string);
+    }
+};
+
+template <typename T>
+using string_map = std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
+
+#endif // TYPEDEF_HPP
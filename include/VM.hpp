@@ -0,0 +1,72 @@
+#ifndef VM_HPP
+#define VM_HPP
+
+#include "Chunk.hpp"
+#include "RuntimeError.hpp"
+#include "Symbol.hpp"
+#include "Value.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A captured variable. While the variable is still on the VM stack 'location' points at its
+// slot; once the slot goes away the value is moved into 'closed'.
+struct VMUpvalue {
+    Value* location;
+    Value closed;
+
+    explicit VMUpvalue(Value* location) : location{location} {}
+};
+
+class VMClosure : public Object {
+public:
+    explicit VMClosure(std::shared_ptr<CompiledFunction> function);
+    std::string toString() const override;
+
+    std::shared_ptr<CompiledFunction> function;
+    std::vector<std::shared_ptr<VMUpvalue>> upvalues;
+};
+
+class VM {
+public:
+    VM();
+
+    void interpret(std::shared_ptr<CompiledFunction> script);
+
+private:
+    struct CallFrame {
+        VMClosure* closure;
+        const uint8_t* ip;
+        Value* slots;
+    };
+
+    // Nested calls allowed before reporting a stack overflow.
+    static constexpr size_t frames_max = 1u << 18;
+    // Values the stack starts with; it doubles whenever a call needs more room.
+    static constexpr size_t stack_initial = 16u * 1024u;
+
+    std::vector<Value> stack;
+    Value* stack_top;
+    std::vector<CallFrame> frames;
+    std::vector<std::shared_ptr<VMUpvalue>> open_upvalues;
+    std::unordered_map<Symbol, Value> globals;
+
+    void run();
+    void push(Value value);
+    Value pop();
+    Value& peek(size_t distance);
+    void resetStack();
+    void growStack(size_t needed);
+    void reserveFrame(const Value* slots, const CompiledFunction& function);
+
+    void callValue(const Value& callee, size_t arg_count);
+    void call(VMClosure* closure, size_t arg_count);
+    std::shared_ptr<VMUpvalue> captureUpvalue(Value* local);
+    void closeUpvalues(const Value* last);
+
+    unsigned int currentLine() const;
+    RuntimeError error(const std::string& message) const;
+};
+
+#endif // VM_HPP
@@ -0,0 +1,297 @@
+#ifndef VALUE_HPP
+#define VALUE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Base class of every heap allocated runtime object. Objects are reference counted intrusively
+// so that a Value stays a 16 byte tagged union.
+class Object {
+public:
+    Object() = default;
+    Object(const Object&) = delete;
+    Object& operator=(const Object&) = delete;
+    virtual ~Object() = default;
+
+    virtual std::string toString() const = 0;
+    // Writes the same text as toString() to the end of 'out'.
+    virtual void appendTo(std::string& out) const { out += toString(); }
+
+    void retain() noexcept {
+        ++refs;
+    }
+
+    void release() noexcept {
+        if (--refs == 0u) {
+            delete this;
+        }
+    }
+
+    uint32_t references() const noexcept {
+        return refs;
+    }
+
+private:
+    uint32_t refs = 0u;
+};
+
+// An immutable string longer than a Value holds inline. Concatenating long strings makes a rope
+// node that refers to both halves and only copies them into one buffer when the characters are
+// first needed, so appending to a string in a loop does not copy everything built so far every
+// time.
+class StringObject : public Object {
+public:
+    explicit StringObject(std::string value) : value{std::move(value)} {}
+    // Takes shared ownership of both halves.
+    StringObject(StringObject* left, StringObject* right);
+    ~StringObject() override;
+
+    std::string toString() const override { return flat(); }
+    void appendTo(std::string& out) const override { out += flat(); }
+
+    const std::string& flat() const {
+        if (left != nullptr) {
+            flatten();
+        }
+        return value;
+    }
+
+    size_t length() const noexcept { return left != nullptr ? size : value.size(); }
+    // False for a rope node whose characters have not been needed yet.
+    bool isFlat() const noexcept { return left == nullptr; }
+
+private:
+    mutable std::string value;
+    // Both set until the node is flattened.
+    mutable StringObject* left = nullptr;
+    mutable StringObject* right = nullptr;
+    size_t size = 0u;
+
+    void flatten() const;
+    static void releaseAll(std::vector<StringObject*> pending) noexcept;
+};
+
+class Value {
+public:
+    enum class Type : uint8_t {
+        NIL,
+        BOOL,
+        // Numbers are integers while they are exact and fit in 64 bits, doubles otherwise.
+        INTEGER,
+        NUMBER,
+        // Strings of up to short_capacity bytes, stored in the Value itself.
+        SHORT_STRING,
+        // Everything from here on holds an Object.
+        STRING,
+        LIST,
+        ARRAY,
+        FUNCTION,
+        NATIVE,
+        CLOSURE,
+        CELL
+    };
+
+    static constexpr size_t short_capacity = 8u;
+
+    Value() noexcept : type{Type::NIL}, bits{0u} {}
+    Value(bool boolean) noexcept : type{Type::BOOL}, bits{0u} { this->boolean = boolean; }
+    Value(int64_t integer) noexcept : type{Type::INTEGER}, integer{integer} {}
+    Value(double number) noexcept : type{Type::NUMBER}, number{number} {}
+    Value(std::string string);
+    Value(const char* string) : Value{std::string{string}} {}
+
+    // Takes shared ownership of 'object', which must match 'type'.
+    Value(Type type, Object* object) noexcept : type{type}, object{object} {
+        object->retain();
+    }
+
+    Value(const Value& other) noexcept : type{other.type}, short_length{other.short_length}, bits{other.bits} {
+        if (isObject()) {
+            object->retain();
+        }
+    }
+
+    Value(Value&& other) noexcept : type{other.type}, short_length{other.short_length}, bits{other.bits} {
+        other.type = Type::NIL;
+    }
+
+    Value& operator=(const Value& other) noexcept {
+        Value copy{other};
+        swap(copy);
+        return *this;
+    }
+
+    Value& operator=(Value&& other) noexcept {
+        Value moved{std::move(other)};
+        swap(moved);
+        return *this;
+    }
+
+    ~Value() {
+        if (isObject()) {
+            object->release();
+        }
+    }
+
+    void swap(Value& other) noexcept {
+        std::swap(type, other.type);
+        std::swap(short_length, other.short_length);
+        std::swap(bits, other.bits);
+    }
+
+    Type getType() const noexcept { return type; }
+    bool isNil() const noexcept { return type == Type::NIL; }
+    bool isBool() const noexcept { return type == Type::BOOL; }
+    bool isNumber() const noexcept { return type == Type::INTEGER || type == Type::NUMBER; }
+    bool isInteger() const noexcept { return type == Type::INTEGER; }
+    bool isString() const noexcept { return type == Type::SHORT_STRING || type == Type::STRING; }
+    bool isList() const noexcept { return type == Type::LIST; }
+    bool isArray() const noexcept { return type == Type::ARRAY; }
+    bool isObject() const noexcept { return type >= Type::STRING; }
+
+    bool asBool() const noexcept { return boolean; }
+    double asNumber() const noexcept { return type == Type::INTEGER ? static_cast<double>(integer) : number; }
+    int64_t asInteger() const noexcept { return integer; }
+    std::string_view asString() const {
+        if (type == Type::SHORT_STRING) {
+            return {chars, short_length};
+        }
+        return static_cast<const StringObject*>(object)->flat();
+    }
+
+    size_t stringLength() const noexcept {
+        return type == Type::SHORT_STRING ? short_length : static_cast<const StringObject*>(object)->length();
+    }
+
+    template <typename T>
+    T& as() const noexcept {
+        return *static_cast<T*>(object);
+    }
+
+    // Where the object pointer is stored, for machine code that checks what a variable holds.
+    const void* objectAddress() const noexcept { return &object; }
+
+    bool isTruthy() const noexcept;
+    bool operator==(const Value& other) const noexcept;
+    std::string toString() const;
+    void appendTo(std::string& out) const;
+
+private:
+    Type type;
+    // Length of a SHORT_STRING; it sits in what would otherwise be padding.
+    uint8_t short_length = 0u;
+    union {
+        bool boolean;
+        int64_t integer;
+        double number;
+        Object* object;
+        char chars[short_capacity];
+        uint64_t bits;
+    };
+};
+
+// Formats a number the way the language prints it: the shortest digits that read back as the same
+// number, never in exponent notation.
+std::string formatNumber(double number);
+std::string formatNumber(int64_t number);
+void appendNumber(std::string& out, double number);
+void appendNumber(std::string& out, int64_t number);
+
+static_assert(sizeof(Value) == 16u);
+
+// Joins two strings.
+Value concatenate(const Value& lhs, const Value& rhs);
+
+// Arithmetic on two numbers. Integer operands give an integer unless the result overflows, is not
+// whole or is -0, which only a double can hold.
+inline Value addNumbers(const Value& lhs, const Value& rhs) noexcept {
+    int64_t result = 0;
+    if (lhs.isInteger() && rhs.isInteger() && !__builtin_add_overflow(lhs.asInteger(), rhs.asInteger(), &result)) {
+        return result;
+    }
+    return lhs.asNumber() + rhs.asNumber();
+}
+
+inline Value subtractNumbers(const Value& lhs, const Value& rhs) noexcept {
+    int64_t result = 0;
+    if (lhs.isInteger() && rhs.isInteger() && !__builtin_sub_overflow(lhs.asInteger(), rhs.asInteger(), &result)) {
+        return result;
+    }
+    return lhs.asNumber() - rhs.asNumber();
+}
+
+inline Value multiplyNumbers(const Value& lhs, const Value& rhs) noexcept {
+    int64_t result = 0;
+    if (lhs.isInteger() && rhs.isInteger() && !__builtin_mul_overflow(lhs.asInteger(), rhs.asInteger(), &result) &&
+        (result != 0 || (lhs.asInteger() >= 0 && rhs.asInteger() >= 0))) {
+        return result;
+    }
+    return lhs.asNumber() * rhs.asNumber();
+}
+
+// The divisor must not be 0.
+inline Value divideNumbers(const Value& lhs, const Value& rhs) noexcept {
+    if (lhs.isInteger() && rhs.isInteger()) {
+        const int64_t dividend = lhs.asInteger();
+        const int64_t divisor = rhs.asInteger();
+        const bool overflows = dividend == INT64_MIN && divisor == -1;
+        if (!overflows && dividend % divisor == 0 && (dividend != 0 || divisor > 0)) {
+            return dividend / divisor;
+        }
+    }
+    return lhs.asNumber() / rhs.asNumber();
+}
+
+// Two integers compare exactly; as soon as one operand is a double both compare as doubles, the
+// way operator== does.
+inline bool equalNumbers(const Value& lhs, const Value& rhs) noexcept {
+    if (lhs.isInteger() && rhs.isInteger()) {
+        return lhs.asInteger() == rhs.asInteger();
+    }
+    return lhs.asNumber() == rhs.asNumber();
+}
+
+// Ordering follows the same rule: exact for two integers, in doubles otherwise. 'a > b' is
+// lessNumbers(b, a).
+inline bool lessNumbers(const Value& lhs, const Value& rhs) noexcept {
+    if (lhs.isInteger() && rhs.isInteger()) {
+        return lhs.asInteger() < rhs.asInteger();
+    }
+    return lhs.asNumber() < rhs.asNumber();
+}
+
+inline bool lessEqualNumbers(const Value& lhs, const Value& rhs) noexcept {
+    if (lhs.isInteger() && rhs.isInteger()) {
+        return lhs.asInteger() <= rhs.asInteger();
+    }
+    return lhs.asNumber() <= rhs.asNumber();
+}
+
+// Reads 'index' as a position in a list or array: an integer as it is, a double only when it is
+// whole. Doubles beyond the int64 range saturate, which is out of range for any sequence.
+inline bool indexPosition(const Value& index, int64_t& position) noexcept {
+    if (index.isInteger()) {
+        position = index.asInteger();
+        return true;
+    }
+    if (!index.isNumber() || std::trunc(index.asNumber()) != index.asNumber()) {
+        return false;
+    }
+    constexpr double limit = 9223372036854775808.0; // 2^63
+    const double number = index.asNumber();
+    position = number >= limit ? INT64_MAX : number < -limit ? INT64_MIN : static_cast<int64_t>(number);
+    return true;
+}
+
+inline Value negateNumber(const Value& value) noexcept {
+    if (value.isInteger() && value.asInteger() != 0 && value.asInteger() != INT64_MIN) {
+        return -value.asInteger();
+    }
+    return -value.asNumber();
+}
+
+#endif // VALUE_HPP
@@ -1,6 +1,7 @@
 #ifndef VISITOR_HPP
 #define VISITOR_HPP
 
+#include "Value.hpp"
 #include <any>
 
 struct AssignExpr;
@@ -44,6 +45,7 @@ struct ExprVisitor {
 struct Expr {
     virtual ~Expr() = default;
     virtual std::any accept(ExprVisitor<std::any>& visitor) const = 0;
+    virtual Value accept(ExprVisitor<Value>& visitor) const = 0;
 };
 
 struct BlockStmt;
@@ -0,0 +1,25 @@
+#include "../include/Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+Arena::Arena(size_t block_size) : block_size{block_size} {
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    auto address = reinterpret_cast<std::uintptr_t>(cursor);
+    auto aligned = (address + alignment - 1u) & ~(static_cast<std::uintptr_t>(alignment) - 1u);
+
+    if (cursor == nullptr || aligned + size > reinterpret_cast<std::uintptr_t>(end)) {
+        // Oversized requests get a block of their own.
+        const size_t capacity = std::max(block_size, size + alignment);
+        auto& block = blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(capacity));
+        cursor = block.get();
+        end = cursor + capacity;
+
+        address = reinterpret_cast<std::uintptr_t>(cursor);
+        aligned = (address + alignment - 1u) & ~(static_cast<std::uintptr_t>(alignment) - 1u);
+    }
+
+    cursor += (aligned - address) + size;
+    return reinterpret_cast<void*>(aligned);
+}
@@ -0,0 +1,294 @@
+#include "../include/ArrayType.hpp"
+#include "../include/RuntimeError.hpp"
+#include <array>
+#include <limits>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define COSMOS_AVX2 1
+#define COSMOS_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+Array::Array(std::vector<double> values) : values{std::move(values)} {
+}
+
+std::string Array::toString() const {
+    std::string result;
+    appendTo(result);
+    return result;
+}
+
+void Array::appendTo(std::string& out) const {
+    out += '[';
+    for (size_t i = 0u; i < values.size(); ++i) {
+        out += (i == 0u) ? " " : ", ";
+        appendNumber(out, values[i]);
+    }
+    out += " ]";
+}
+
+namespace {
+
+// Operations on one element and on four at once. Like the MINPD/MAXPD instructions, min and max
+// return 'rhs' when the operands compare equal or either is NaN.
+struct Add {
+    static double apply(double lhs, double rhs) noexcept { return lhs + rhs; }
+#ifdef COSMOS_AVX2
+    COSMOS_TARGET_AVX2 static __m256d apply(__m256d lhs, __m256d rhs) noexcept { return _mm256_add_pd(lhs, rhs); }
+#endif
+};
+
+struct Subtract {
+    static double apply(double lhs, double rhs) noexcept { return lhs - rhs; }
+#ifdef COSMOS_AVX2
+    COSMOS_TARGET_AVX2 static __m256d apply(__m256d lhs, __m256d rhs) noexcept { return _mm256_sub_pd(lhs, rhs); }
+#endif
+};
+
+struct Multiply {
+    static double apply(double lhs, double rhs) noexcept { return lhs * rhs; }
+#ifdef COSMOS_AVX2
+    COSMOS_TARGET_AVX2 static __m256d apply(__m256d lhs, __m256d rhs) noexcept { return _mm256_mul_pd(lhs, rhs); }
+#endif
+};
+
+struct Divide {
+    static double apply(double lhs, double rhs) noexcept { return lhs / rhs; }
+#ifdef COSMOS_AVX2
+    COSMOS_TARGET_AVX2 static __m256d apply(__m256d lhs, __m256d rhs) noexcept { return _mm256_div_pd(lhs, rhs); }
+#endif
+};
+
+struct Min {
+    static double apply(double lhs, double rhs) noexcept { return lhs < rhs ? lhs : rhs; }
+#ifdef COSMOS_AVX2
+    COSMOS_TARGET_AVX2 static __m256d apply(__m256d lhs, __m256d rhs) noexcept { return _mm256_min_pd(lhs, rhs); }
+#endif
+};
+
+struct Max {
+    static double apply(double lhs, double rhs) noexcept { return lhs > rhs ? lhs : rhs; }
+#ifdef COSMOS_AVX2
+    COSMOS_TARGET_AVX2 static __m256d apply(__m256d lhs, __m256d rhs) noexcept { return _mm256_max_pd(lhs, rhs); }
+#endif
+};
+
+// Reductions keep one partial result per lane of four unrolled AVX2 registers: element i goes to
+// partial i % lanes, and the partials are combined from left to right at the end. Each element is
+// the left operand, so min and max skip NaN elements.
+constexpr size_t lanes = 16u;
+using Partials = std::array<double, lanes>;
+
+template <typename Op>
+double combine(const Partials& partials) noexcept {
+    double result = partials[0];
+    for (size_t i = 1u; i < lanes; ++i) {
+        result = Op::apply(partials[i], result);
+    }
+    return result;
+}
+
+template <typename Op>
+double reducePortable(std::span<const double> values, double initial) noexcept {
+    Partials partials;
+    partials.fill(initial);
+    for (size_t i = 0u; i < values.size(); ++i) {
+        partials[i % lanes] = Op::apply(values[i], partials[i % lanes]);
+    }
+    return combine<Op>(partials);
+}
+
+double dotPortable(std::span<const double> lhs, std::span<const double> rhs) noexcept {
+    Partials partials;
+    partials.fill(0.0);
+    for (size_t i = 0u; i < lhs.size(); ++i) {
+        partials[i % lanes] += lhs[i] * rhs[i];
+    }
+    return combine<Add>(partials);
+}
+
+// A single number stands for every element of an operand when 'lhs_scalar' or 'rhs_scalar' is
+// set.
+template <typename Op, bool lhs_scalar, bool rhs_scalar>
+void applyPortable(const double* lhs, const double* rhs, double* out, size_t count) noexcept {
+    for (size_t i = 0u; i < count; ++i) {
+        out[i] = Op::apply(lhs[lhs_scalar ? 0u : i], rhs[rhs_scalar ? 0u : i]);
+    }
+}
+
+#ifdef COSMOS_AVX2
+
+bool hasAvx2() noexcept {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+template <typename Op>
+COSMOS_TARGET_AVX2 double reduceAvx2(std::span<const double> values, double initial) noexcept {
+    const double* data = values.data();
+    __m256d acc0 = _mm256_set1_pd(initial);
+    __m256d acc1 = acc0;
+    __m256d acc2 = acc0;
+    __m256d acc3 = acc0;
+
+    size_t i = 0u;
+    for (; i + lanes <= values.size(); i += lanes) {
+        acc0 = Op::apply(_mm256_loadu_pd(data + i), acc0);
+        acc1 = Op::apply(_mm256_loadu_pd(data + i + 4u), acc1);
+        acc2 = Op::apply(_mm256_loadu_pd(data + i + 8u), acc2);
+        acc3 = Op::apply(_mm256_loadu_pd(data + i + 12u), acc3);
+    }
+
+    Partials partials;
+    _mm256_storeu_pd(partials.data(), acc0);
+    _mm256_storeu_pd(partials.data() + 4u, acc1);
+    _mm256_storeu_pd(partials.data() + 8u, acc2);
+    _mm256_storeu_pd(partials.data() + 12u, acc3);
+    for (; i < values.size(); ++i) {
+        partials[i % lanes] = Op::apply(data[i], partials[i % lanes]);
+    }
+    return combine<Op>(partials);
+}
+
+// Multiplies and then adds instead of using FMA, which would round differently from the portable
+// version.
+COSMOS_TARGET_AVX2 double dotAvx2(std::span<const double> lhs, std::span<const double> rhs) noexcept {
+    const double* a = lhs.data();
+    const double* b = rhs.data();
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = acc0;
+    __m256d acc2 = acc0;
+    __m256d acc3 = acc0;
+
+    size_t i = 0u;
+    for (; i + lanes <= lhs.size(); i += lanes) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4u), _mm256_loadu_pd(b + i + 4u)));
+        acc2 = _mm256_add_pd(acc2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8u), _mm256_loadu_pd(b + i + 8u)));
+        acc3 = _mm256_add_pd(acc3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12u), _mm256_loadu_pd(b + i + 12u)));
+    }
+
+    Partials partials;
+    _mm256_storeu_pd(partials.data(), acc0);
+    _mm256_storeu_pd(partials.data() + 4u, acc1);
+    _mm256_storeu_pd(partials.data() + 8u, acc2);
+    _mm256_storeu_pd(partials.data() + 12u, acc3);
+    for (; i < lhs.size(); ++i) {
+        partials[i % lanes] += a[i] * b[i];
+    }
+    return combine<Add>(partials);
+}
+
+template <typename Op, bool lhs_scalar, bool rhs_scalar>
+COSMOS_TARGET_AVX2 void applyAvx2(const double* lhs, const double* rhs, double* out, size_t count) noexcept {
+    const __m256d lhs_all = _mm256_set1_pd(lhs_scalar ? lhs[0] : 0.0);
+    const __m256d rhs_all = _mm256_set1_pd(rhs_scalar ? rhs[0] : 0.0);
+
+    size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+        const __m256d a = lhs_scalar ? lhs_all : _mm256_loadu_pd(lhs + i);
+        const __m256d b = rhs_scalar ? rhs_all : _mm256_loadu_pd(rhs + i);
+        _mm256_storeu_pd(out + i, Op::apply(a, b));
+    }
+    for (; i < count; ++i) {
+        out[i] = Op::apply(lhs[lhs_scalar ? 0u : i], rhs[rhs_scalar ? 0u : i]);
+    }
+}
+
+#endif
+
+template <typename Op>
+double reduce(std::span<const double> values, double initial) noexcept {
+#ifdef COSMOS_AVX2
+    if (hasAvx2()) {
+        return reduceAvx2<Op>(values, initial);
+    }
+#endif
+    return reducePortable<Op>(values, initial);
+}
+
+template <typename Op, bool lhs_scalar, bool rhs_scalar>
+void apply(const double* lhs, const double* rhs, double* out, size_t count) noexcept {
+#ifdef COSMOS_AVX2
+    if (hasAvx2()) {
+        applyAvx2<Op, lhs_scalar, rhs_scalar>(lhs, rhs, out, count);
+        return;
+    }
+#endif
+    applyPortable<Op, lhs_scalar, rhs_scalar>(lhs, rhs, out, count);
+}
+
+template <bool lhs_scalar, bool rhs_scalar>
+Value apply(ArrayOperation op, const double* lhs, const double* rhs, size_t count) {
+    std::vector<double> result(count);
+    switch (op) {
+    case ArrayOperation::ADD:
+        apply<Add, lhs_scalar, rhs_scalar>(lhs, rhs, result.data(), count);
+        break;
+    case ArrayOperation::SUBTRACT:
+        apply<Subtract, lhs_scalar, rhs_scalar>(lhs, rhs, result.data(), count);
+        break;
+    case ArrayOperation::MULTIPLY:
+        apply<Multiply, lhs_scalar, rhs_scalar>(lhs, rhs, result.data(), count);
+        break;
+    case ArrayOperation::DIVIDE:
+        apply<Divide, lhs_scalar, rhs_scalar>(lhs, rhs, result.data(), count);
+        break;
+    }
+    return Value{Value::Type::ARRAY, new Array{std::move(result)}};
+}
+
+} // namespace
+
+Value elementwise(ArrayOperation op, const Value& lhs, const Value& rhs) {
+    if (lhs.isArray() && rhs.isArray()) {
+        const auto left = lhs.as<Array>().elements();
+        const auto right = rhs.as<Array>().elements();
+        if (left.size() != right.size()) {
+            throw NativeError("Arrays must have the same length, but got " + std::to_string(left.size()) + " and " + std::to_string(right.size()) + ".");
+        }
+        return apply<false, false>(op, left.data(), right.data(), left.size());
+    }
+    if (lhs.isArray() && rhs.isNumber()) {
+        const auto left = lhs.as<Array>().elements();
+        const double right = rhs.asNumber();
+        return apply<false, true>(op, left.data(), &right, left.size());
+    }
+    if (lhs.isNumber() && rhs.isArray()) {
+        const double left = lhs.asNumber();
+        const auto right = rhs.as<Array>().elements();
+        return apply<true, false>(op, &left, right.data(), right.size());
+    }
+    throw NativeError("Operands must be numbers or arrays.");
+}
+
+namespace kernels {
+
+double sum(std::span<const double> values) noexcept {
+    return reduce<Add>(values, 0.0);
+}
+
+double min(std::span<const double> values) noexcept {
+    return reduce<Min>(values, std::numeric_limits<double>::infinity());
+}
+
+double max(std::span<const double> values) noexcept {
+    return reduce<Max>(values, -std::numeric_limits<double>::infinity());
+}
+
+double dot(std::span<const double> lhs, std::span<const double> rhs) noexcept {
+#ifdef COSMOS_AVX2
+    if (hasAvx2()) {
+        return dotAvx2(lhs, rhs);
+    }
+#endif
+    return dotPortable(lhs, rhs);
+}
+
+std::vector<double> scale(std::span<const double> values, double factor) {
+    std::vector<double> result(values.size());
+    apply<Multiply, false, true>(values.data(), &factor, result.data(), values.size());
+    return result;
+}
+
+} // namespace kernels
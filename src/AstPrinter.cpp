@@ -8,12 +8,12 @@ std::string AstPrinter::print(const std::vector<unique_expr_ptr>& expressions) {
 }
 
 std::any AstPrinter::visit(const BinaryExpr& expr) {
-    parenthesize(expr.op.lexeme, {std::move(expr.left.get()), std::move(expr.right.get())});
+    parenthesize(std::string{expr.op.lexeme()}, {std::move(expr.left.get()), std::move(expr.right.get())});
     return {};
 }
 
 std::any AstPrinter::visit(const UnaryExpr& expr) {
-    parenthesize(expr.op.lexeme, {std::move(expr.right.get())});
+    parenthesize(std::string{expr.op.lexeme()}, {std::move(expr.right.get())});
     return {};
 }
 
@@ -23,19 +23,13 @@ std::any AstPrinter::visit(const GroupingExpr& expr) {
 }
 
 std::any AstPrinter::visit(const LiteralExpr& expr) {
-    if (expr.literal.type() == typeid(double)) {
-        stream << std::any_cast<double>(expr.literal);
-    } else if (expr.literal.type() == typeid(std::string)) {
-        stream << std::any_cast<std::string>(expr.literal);
-    } else {
-        stream << "nil";
-    }
+    stream << expr.literal.toString();
 
     return {};
 }
 
 std::any AstPrinter::visit(const AssignExpr& expr) {
-    parenthesize("=" + expr.identifier.lexeme, {std::move(expr.value.get())});
+    parenthesize("=" + std::string{expr.identifier.lexeme()}, {std::move(expr.value.get())});
     return {};
 }
 
@@ -53,26 +47,26 @@ std::any AstPrinter::visit(const CallExpr& expr) {
 std::any AstPrinter::visit(const GetExpr& expr) {
     stream << "(. ";
     expr.object.get()->accept(*this);
-    stream << expr.identifier.lexeme + ")";
+    stream << expr.identifier.lexeme() << ")";
     return {};
 }
 
 std::any AstPrinter::visit(const SetExpr& expr) {
     stream << "(= ";
     expr.object.get()->accept(*this);
-    stream << " " + expr.identifier.lexeme + " ";
+    stream << " " + std::string{expr.identifier.lexeme()} + " ";
     expr.value.get()->accept(*this);
     stream << ")";
     return {};
 }
 
 std::any AstPrinter::visit(const SuperExpr& expr) {
-    stream << "(super " + expr.method.lexeme + ")";
+    stream << "(super " + std::string{expr.method.lexeme()} + ")";
     return {};
 }
 
 std::any AstPrinter::visit(const LogicalExpr& expr) {
-    parenthesize(expr.op.lexeme, {std::move(expr.left.get()), std::move(expr.right.get())});
+    parenthesize(std::string{expr.op.lexeme()}, {std::move(expr.left.get()), std::move(expr.right.get())});
     return {};
 }
 
@@ -82,7 +76,7 @@ std::any AstPrinter::visit(const ThisExpr& expr) {
 }
 
 std::any AstPrinter::visit(const VarExpr& expr) {
-    stream << expr.identifier.lexeme;
+    stream << expr.identifier.lexeme();
     return {};
 }
 
@@ -1,12 +1,13 @@
-
 #include "../include/BuiltIn.hpp"
+#include "../include/ListType.hpp"
+#include <cmath>
 
 // Native clock
 size_t ClockCallable::getArity() const {
     return 0u;
 }
 
-std::any ClockCallable::call(Interpreter& interpreter, const std::vector<std::any>& args) const {
+Value ClockCallable::callNative(std::span<const Value> args) const {
     static_assert(std::is_integral_v<std::chrono::system_clock::rep>, "Representation of ticks isn't an integral value.");
 
     // Returns Unix time in seconds.
@@ -20,15 +21,23 @@ std::string ClockCallable::toString() const {
 
 // Native print
 size_t PrintCallable::getArity() const {
-    return arity;
+    return variadic;
 }
 
-std::any PrintCallable::call(Interpreter& interpreter, const std::vector<std::any>& args) const {
-    std::stringstream stream;
+Value PrintCallable::callNative(std::span<const Value> args) const {
+    auto& output = Output::standard();
     for (const auto& arg : args) {
-        stream << stringify(arg, stream) << ' ';
+        // A string holding just the escape '\n' or '\t' prints the character it stands for.
+        if (arg.isString() && arg.asString() == "\\n") {
+            output.append('\n');
+        } else if (arg.isString() && arg.asString() == "\\t") {
+            output.append('\t');
+        } else {
+            output.append(arg);
+        }
+        output.append(' ');
     }
-    std::cout << stream.str() << '\n';
+    output.endLine();
     return {};
 }
 
@@ -36,54 +45,155 @@ std::string PrintCallable::toString() const {
     return "native print";
 }
 
-std::string stringify(const std::any& item, std::stringstream& stream) {
-    if (item.type() == typeid(shared_ptr_any)) {
-        return stringify(*(std::any_cast<shared_ptr_any>(item)), stream);
+// Native flush
+size_t FlushCallable::getArity() const {
+    return 0u;
+}
+
+Value FlushCallable::callNative(std::span<const Value> args) const {
+    Output::standard().flush();
+    return {};
+}
+
+std::string FlushCallable::toString() const {
+    return "<native fn>";
+}
+
+namespace {
+
+const Array& arrayArgument(const Value& arg, const char* function) {
+    if (!arg.isArray()) {
+        throw NativeError(std::string{function} + "() expects an array.");
     }
+    return arg.as<Array>();
+}
 
-    if (item.type() == typeid(bool))
-        return std::any_cast<bool>(item) ? "true" : "false";
+double numberArgument(const Value& arg, const char* function) {
+    if (!arg.isNumber()) {
+        throw NativeError(std::string{function} + "() expects a number.");
+    }
+    return arg.asNumber();
+}
 
-    if (item.type() == typeid(char))
-        return std::to_string(std::any_cast<char>(item));
+} // namespace
 
-    if (item.type() == typeid(FunctionType))
-        return std::any_cast<FunctionType>(item).toString();
+// Native array
+size_t ArrayCallable::getArity() const {
+    return 1u;
+}
 
-    if (item.type() == typeid(std::string)) {
-        auto str = std::any_cast<std::string>(item);
-        if (str == "\\n")
-            return "\n";
-        else if (str == "\\t")
-            return "\t";
-        else
-            return str;
+Value ArrayCallable::callNative(std::span<const Value> args) const {
+    const auto& arg = args[0];
+    std::vector<double> values;
+
+    if (arg.isList()) {
+        // Copies a list of numbers.
+        auto& list = arg.as<List>();
+        values.reserve(list.length());
+        for (size_t i = 0u; i < list.length(); ++i) {
+            const auto& item = list.at(static_cast<int>(i));
+            if (!item.isNumber()) {
+                throw NativeError("Array elements must be numbers.");
+            }
+            values.push_back(item.asNumber());
+        }
+    } else if (arg.isArray()) {
+        const auto elements = arg.as<Array>().elements();
+        values.assign(elements.begin(), elements.end());
+    } else if (arg.isNumber()) {
+        // Makes that many zeros.
+        const double length = arg.asNumber();
+        if (length < 0 || std::trunc(length) != length || length > static_cast<double>(values.max_size())) {
+            throw NativeError("Array length must be a non-negative integer.");
+        }
+        values.resize(static_cast<size_t>(length));
+    } else {
+        throw NativeError("array() expects a list of numbers, an array or a length.");
     }
 
-    if (item.type() == typeid(double)) {
-        auto num_as_string = std::to_string(std::any_cast<double>(item));
-        num_as_string.erase(num_as_string.find_last_not_of('0') + 1, std::string::npos);
-        num_as_string.erase(num_as_string.find_last_not_of('.') + 1, std::string::npos);
-        return num_as_string;
+    return Value{Value::Type::ARRAY, new Array{std::move(values)}};
+}
+
+std::string ArrayCallable::toString() const {
+    return "<native fn>";
+}
+
+// Native sum
+size_t SumCallable::getArity() const {
+    return 1u;
+}
+
+Value SumCallable::callNative(std::span<const Value> args) const {
+    return kernels::sum(arrayArgument(args[0], "sum").elements());
+}
+
+std::string SumCallable::toString() const {
+    return "<native fn>";
+}
+
+// Native min
+size_t MinCallable::getArity() const {
+    return 1u;
+}
+
+Value MinCallable::callNative(std::span<const Value> args) const {
+    const auto& array = arrayArgument(args[0], "min");
+    if (array.length() == 0u) {
+        throw NativeError("min() of an empty array.");
     }
+    return kernels::min(array.elements());
+}
+
+std::string MinCallable::toString() const {
+    return "<native fn>";
+}
+
+// Native max
+size_t MaxCallable::getArity() const {
+    return 1u;
+}
 
-    if (item.type() == typeid(int)) {
-        return std::to_string(std::any_cast<int>(item));
+Value MaxCallable::callNative(std::span<const Value> args) const {
+    const auto& array = arrayArgument(args[0], "max");
+    if (array.length() == 0u) {
+        throw NativeError("max() of an empty array.");
     }
+    return kernels::max(array.elements());
+}
 
-    if (item.type() == typeid(std::shared_ptr<List>)) {
-        auto items = std::any_cast<std::shared_ptr<List>>(item);
-        stream << "[";
-        auto len = items->length();
-        for (size_t i = 0u; i < len; ++i) {
-            stream << ' ';
-            stream << stringify(items->at(static_cast<int>(i)), stream);
-            stream << ",";
-        }
-        stream.seekp(-1, std::ios_base::end);
-        stream << " ]";
-        return {};
+std::string MaxCallable::toString() const {
+    return "<native fn>";
+}
+
+// Native dot
+size_t DotCallable::getArity() const {
+    return 2u;
+}
+
+Value DotCallable::callNative(std::span<const Value> args) const {
+    const auto& lhs = arrayArgument(args[0], "dot");
+    const auto& rhs = arrayArgument(args[1], "dot");
+    if (lhs.length() != rhs.length()) {
+        throw NativeError("Arrays must have the same length, but got " + std::to_string(lhs.length()) + " and " + std::to_string(rhs.length()) + ".");
     }
+    return kernels::dot(lhs.elements(), rhs.elements());
+}
 
-    return "nil";
+std::string DotCallable::toString() const {
+    return "<native fn>";
+}
+
+// Native scale
+size_t ScaleCallable::getArity() const {
+    return 2u;
+}
+
+Value ScaleCallable::callNative(std::span<const Value> args) const {
+    const auto& array = arrayArgument(args[0], "scale");
+    const double factor = numberArgument(args[1], "scale");
+    return Value{Value::Type::ARRAY, new Array{kernels::scale(array.elements(), factor)}};
+}
+
+std::string ScaleCallable::toString() const {
+    return "<native fn>";
 }
@@ -0,0 +1,16 @@
+#include "../include/Chunk.hpp"
+
+void Chunk::write(uint8_t byte, unsigned int line) {
+    code.push_back(byte);
+    lines.push_back(line);
+}
+
+size_t Chunk::addConstant(Value value) {
+    constants.emplace_back(std::move(value));
+    return constants.size() - 1;
+}
+
+size_t Chunk::addFunction(std::shared_ptr<CompiledFunction> function) {
+    functions.emplace_back(std::move(function));
+    return functions.size() - 1;
+}
@@ -0,0 +1,742 @@
+#include "../include/Compiler.hpp"
+#include "../include/Logger.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // Locals and upvalues are addressed with 16 bits, argument and item counts with 8.
+    constexpr size_t max_locals = std::numeric_limits<uint16_t>::max() + 1u;
+    constexpr size_t max_arguments = std::numeric_limits<uint8_t>::max() + 1u;
+    constexpr size_t max_short = std::numeric_limits<uint16_t>::max();
+    constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    // Operand bytes and net stack effect of each instruction with fixed ones.
+    struct Effect {
+        size_t operands;
+        int stack;
+    };
+
+    Effect effectOf(OpCode op) {
+        using enum OpCode;
+        switch (op) {
+        case NIL:
+        case TRUE:
+        case FALSE:
+        case DUP:
+            return {0u, 1};
+        case POP:
+        case CLOSE_UPVALUE:
+        case EQUAL:
+        case NOT_EQUAL:
+        case GREATER:
+        case GREATER_EQUAL:
+        case LESS:
+        case LESS_EQUAL:
+        case ADD:
+        case SUBTRACT:
+        case MULTIPLY:
+        case DIVIDE:
+            return {0u, -1};
+        case CONSTANT:
+        case GET_LOCAL:
+        case GET_GLOBAL:
+        case GET_UPVALUE:
+            return {2u, 1};
+        case DEFINE_GLOBAL:
+        case GET_INDEX:
+            return {2u, -1};
+        case SET_INDEX:
+            return {2u, -2};
+        case SET_LOCAL:
+        case SET_GLOBAL:
+        case SET_UPVALUE:
+        case INCREMENT:
+        case DECREMENT:
+            return {2u, 0};
+        default:
+            // NOT and NEGATE replace their operand.
+            return {0u, 0};
+        }
+    }
+
+    // Follows every path through 'chunk' to find how many values its frame holds at most, starting
+    // with the 'depth' values there on entry: the function itself and its arguments.
+    size_t maxStackDepth(const Chunk& chunk, size_t depth) {
+        const auto& code = chunk.code;
+        // Depth on arrival at each offset, or npos where no path has arrived yet.
+        std::vector<size_t> arrival(code.size(), npos);
+        std::vector<size_t> pending{0u};
+        arrival[0] = depth;
+        size_t deepest = depth;
+
+        const auto reach = [&](size_t offset, size_t height) {
+            if (offset < code.size() && (arrival[offset] == npos || arrival[offset] < height)) {
+                arrival[offset] = height;
+                pending.push_back(offset);
+            }
+        };
+        const auto readShort = [&](size_t offset) {
+            return offset + 1u < code.size() ? static_cast<size_t>(code[offset] << 8 | code[offset + 1u]) : 0u;
+        };
+
+        while (!pending.empty()) {
+            size_t offset = pending.back();
+            pending.pop_back();
+            size_t height = arrival[offset];
+            while (offset < code.size()) {
+                const auto op = static_cast<OpCode>(code[offset++]);
+                size_t next = offset;
+                switch (op) {
+                case OpCode::JUMP:
+                    reach(offset + 2u + readShort(offset), height);
+                    next = code.size();
+                    break;
+                case OpCode::JUMP_IF_FALSE:
+                    reach(offset + 2u + readShort(offset), height);
+                    next = offset + 2u;
+                    break;
+                case OpCode::LOOP:
+                    reach(offset + 2u - readShort(offset), height);
+                    next = code.size();
+                    break;
+                case OpCode::RETURN:
+                    next = code.size();
+                    break;
+                case OpCode::BUILD_LIST:
+                    height = height + 1u - std::min<size_t>(height, code[offset]);
+                    next = offset + 1u;
+                    break;
+                case OpCode::CALL:
+                case OpCode::TAIL_CALL:
+                    height -= std::min<size_t>(height, code[offset]);
+                    next = offset + 1u;
+                    break;
+                case OpCode::CLOSURE: {
+                    const size_t index = readShort(offset);
+                    const size_t upvalues = index < chunk.functions.size() ? chunk.functions[index]->upvalue_count : 0u;
+                    ++height;
+                    next = offset + 2u + 3u * upvalues;
+                    break;
+                }
+                default: {
+                    const auto [operands, stack] = effectOf(op);
+                    height = stack < 0 ? height - std::min<size_t>(height, static_cast<size_t>(-stack)) : height + static_cast<size_t>(stack);
+                    next = offset + operands;
+                    break;
+                }
+                }
+                deepest = std::max(deepest, height);
+                if (next >= code.size() || (arrival[next] != npos && arrival[next] >= height)) {
+                    break;
+                }
+                arrival[next] = height;
+                offset = next;
+            }
+        }
+        return deepest;
+    }
+}
+
+std::shared_ptr<CompiledFunction> Compiler::compile(const std::vector<unique_stmt_ptr>& statements) {
+    FunctionState script{nullptr, std::make_shared<CompiledFunction>(), {}, {}, {}, 0, {}, false};
+    script.function->name = "script";
+    // Slot zero holds the function being executed.
+    script.locals.push_back({Symbols::none, 0, false});
+    current = &script;
+
+    for (const auto& stmt : statements) {
+        assert(stmt != nullptr);
+        compile(*stmt);
+    }
+    emit(OpCode::NIL);
+    emit(OpCode::RETURN);
+    script.function->stack_size = maxStackDepth(chunk(), 1u);
+
+    current = nullptr;
+    return script.function;
+}
+
+Chunk& Compiler::chunk() {
+    return current->function->chunk;
+}
+
+void Compiler::compile(const Stmt& stmt) {
+    stmt.accept(*this);
+}
+
+void Compiler::compile(const Expr& expr) {
+    expr.accept(*this);
+}
+
+void Compiler::emit(OpCode op) {
+    chunk().write(static_cast<uint8_t>(op), line);
+}
+
+void Compiler::emitByte(uint8_t byte) {
+    chunk().write(byte, line);
+}
+
+void Compiler::emitShort(size_t value) {
+    emitByte(static_cast<uint8_t>((value >> 8) & 0xff));
+    emitByte(static_cast<uint8_t>(value & 0xff));
+}
+
+size_t Compiler::makeConstant(Value value) {
+    if (chunk().constants.size() > max_short) {
+        // Reported once per chunk; the program cannot run anyway.
+        if (!current->constants_exhausted) {
+            error("Too many constants in one chunk.");
+            current->constants_exhausted = true;
+        }
+        return 0u;
+    }
+    return chunk().addConstant(std::move(value));
+}
+
+void Compiler::emitConstant(Value value) {
+    const size_t index = makeConstant(std::move(value));
+    emit(OpCode::CONSTANT);
+    emitShort(index);
+}
+
+// Names are referenced by their symbol, stored as a number constant.
+size_t Compiler::identifierConstant(const Token& identifier) {
+    const auto [entry, inserted] = current->identifiers.try_emplace(identifier.symbol, 0u);
+    if (inserted) {
+        entry->second = makeConstant(static_cast<double>(identifier.symbol));
+    }
+    return entry->second;
+}
+
+size_t Compiler::emitJump(OpCode op) {
+    emit(op);
+    emitShort(0xffff);
+    return chunk().code.size() - 2;
+}
+
+void Compiler::patchJump(size_t offset) {
+    // Jump over the operand of the jump itself.
+    const size_t jump = chunk().code.size() - offset - 2;
+    if (jump > max_short) {
+        error("Too much code to jump over.");
+    }
+    chunk().code[offset] = static_cast<uint8_t>((jump >> 8) & 0xff);
+    chunk().code[offset + 1] = static_cast<uint8_t>(jump & 0xff);
+}
+
+void Compiler::emitLoop(size_t loop_start) {
+    emit(OpCode::LOOP);
+    const size_t offset = chunk().code.size() - loop_start + 2;
+    if (offset > max_short) {
+        error("Loop body too large.");
+    }
+    emitShort(offset);
+}
+
+void Compiler::beginScope() {
+    current->scope_depth++;
+}
+
+void Compiler::endScope() {
+    current->scope_depth--;
+    discardLocals(current->scope_depth);
+    while (!current->locals.empty() && current->locals.back().depth > current->scope_depth) {
+        current->locals.pop_back();
+    }
+}
+
+// Emits the instructions that drop every local deeper than 'depth' without forgetting them at
+// compile time, so that 'eject' and 'warp' can leave nested scopes.
+void Compiler::discardLocals(int depth) {
+    for (auto local = current->locals.rbegin(); local != current->locals.rend() && local->depth > depth; ++local) {
+        emit(local->is_captured ? OpCode::CLOSE_UPVALUE : OpCode::POP);
+    }
+}
+
+void Compiler::declareLocal(const Token& identifier) {
+    if (current->locals.size() >= max_locals) {
+        error("Too many local variables in function.");
+        return;
+    }
+    current->locals.push_back({identifier.symbol, -1, false});
+}
+
+void Compiler::markInitialized() {
+    if (current->scope_depth == 0) {
+        return;
+    }
+    current->locals.back().depth = current->scope_depth;
+}
+
+void Compiler::defineVariable(const Token& identifier) {
+    if (current->scope_depth > 0) {
+        markInitialized();
+        return;
+    }
+    emit(OpCode::DEFINE_GLOBAL);
+    emitShort(identifierConstant(identifier));
+}
+
+int Compiler::resolveLocal(FunctionState& state, Symbol name) {
+    for (int i = static_cast<int>(state.locals.size()) - 1; i >= 0; --i) {
+        if (state.locals[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int Compiler::addUpvalue(FunctionState& state, uint16_t index, bool is_local) {
+    for (size_t i = 0u; i < state.upvalues.size(); ++i) {
+        if (state.upvalues[i].index == index && state.upvalues[i].is_local == is_local) {
+            return static_cast<int>(i);
+        }
+    }
+
+    if (state.upvalues.size() >= max_locals) {
+        error("Too many closure variables in function.");
+        return 0;
+    }
+    state.upvalues.push_back({index, is_local});
+    state.function->upvalue_count = state.upvalues.size();
+    return static_cast<int>(state.upvalues.size() - 1);
+}
+
+int Compiler::resolveUpvalue(FunctionState& state, Symbol name) {
+    if (state.enclosing == nullptr) {
+        return -1;
+    }
+
+    if (const int local = resolveLocal(*state.enclosing, name); local != -1) {
+        state.enclosing->locals[local].is_captured = true;
+        return addUpvalue(state, static_cast<uint16_t>(local), true);
+    }
+
+    if (const int upvalue = resolveUpvalue(*state.enclosing, name); upvalue != -1) {
+        return addUpvalue(state, static_cast<uint16_t>(upvalue), false);
+    }
+    return -1;
+}
+
+void Compiler::namedVariable(const Token& identifier, bool assign) {
+    line = identifier.line;
+    if (const int local = resolveLocal(*current, identifier.symbol); local != -1) {
+        emit(assign ? OpCode::SET_LOCAL : OpCode::GET_LOCAL);
+        emitShort(static_cast<size_t>(local));
+    } else if (const int upvalue = resolveUpvalue(*current, identifier.symbol); upvalue != -1) {
+        emit(assign ? OpCode::SET_UPVALUE : OpCode::GET_UPVALUE);
+        emitShort(static_cast<size_t>(upvalue));
+    } else {
+        emit(assign ? OpCode::SET_GLOBAL : OpCode::GET_GLOBAL);
+        emitShort(identifierConstant(identifier));
+    }
+}
+
+void Compiler::error(const std::string& message) {
+    Error::addError(line, "", message);
+}
+
+void Compiler::compileFunction(const FnStmt& stmt) {
+    FunctionState state{current, std::make_shared<CompiledFunction>(), {}, {}, {}, 0, {}, false};
+    state.function->name = std::string{stmt.identifier.lexeme()};
+    state.function->arity = stmt.params.size();
+    state.locals.push_back({Symbols::none, 0, false});
+    current = &state;
+
+    beginScope();
+    for (const auto& param : stmt.params) {
+        declareLocal(param);
+        markInitialized();
+    }
+    for (const auto& statement : stmt.body) {
+        assert(statement != nullptr);
+        compile(*statement);
+    }
+    emit(OpCode::NIL);
+    emit(OpCode::RETURN);
+    state.function->stack_size = maxStackDepth(chunk(), 1u + stmt.params.size());
+
+    current = state.enclosing;
+    emit(OpCode::CLOSURE);
+    const size_t index = chunk().addFunction(state.function);
+    if (index > max_short) {
+        error("Too many functions in one chunk.");
+    }
+    emitShort(index);
+    for (const auto& upvalue : state.upvalues) {
+        emitByte(upvalue.is_local ? 1 : 0);
+        emitShort(upvalue.index);
+    }
+}
+
+void Compiler::visit(const BlockStmt& stmt) {
+    beginScope();
+    for (const auto& statement : stmt.statements) {
+        assert(statement != nullptr);
+        compile(*statement);
+    }
+    endScope();
+}
+
+void Compiler::visit(const ClassStmt&) {
+}
+
+void Compiler::visit(const ExprStmt& stmt) {
+    compile(*stmt.expression);
+    emit(OpCode::POP);
+}
+
+void Compiler::visit(const FnStmt& stmt) {
+    line = stmt.identifier.line;
+    // Declare the name before compiling the body so the function can refer to itself.
+    if (current->scope_depth > 0) {
+        declareLocal(stmt.identifier);
+        markInitialized();
+    }
+    compileFunction(stmt);
+    defineVariable(stmt.identifier);
+}
+
+void Compiler::visit(const IfStmt& stmt) {
+    std::vector<size_t> end_jumps;
+
+    auto branch = [&](const IfBranch& if_branch) {
+        compile(*if_branch.condition);
+        const size_t next_jump = emitJump(OpCode::JUMP_IF_FALSE);
+        emit(OpCode::POP);
+        compile(*if_branch.statement);
+        end_jumps.push_back(emitJump(OpCode::JUMP));
+        patchJump(next_jump);
+        emit(OpCode::POP);
+    };
+
+    branch(stmt.main_branch);
+    for (const auto& elif : stmt.elif_branches) {
+        branch(elif);
+    }
+    if (stmt.else_branch) {
+        compile(*stmt.else_branch);
+    }
+
+    for (const auto jump : end_jumps) {
+        patchJump(jump);
+    }
+}
+
+void Compiler::visit(const PrintStmt& stmt) {
+    compile(*stmt.expression);
+    emit(OpCode::POP);
+}
+
+void Compiler::visit(const ReturnStmt& stmt) {
+    line = stmt.keyword.line;
+    if (stmt.tail_call) {
+        // RETURN only runs when the callee turns out to be a native.
+        compileCall(static_cast<const CallExpr&>(*stmt.expression), OpCode::TAIL_CALL);
+    } else if (stmt.expression) {
+        compile(*stmt.expression);
+    } else {
+        emit(OpCode::NIL);
+    }
+    emit(OpCode::RETURN);
+}
+
+void Compiler::visit(const BreakStmt& stmt) {
+    line = stmt.keyword.line;
+    if (current->loops.empty()) {
+        error("Can't break outside of a loop.");
+        return;
+    }
+    auto& loop = current->loops.back();
+    discardLocals(loop.scope_depth);
+    loop.break_jumps.push_back(emitJump(OpCode::JUMP));
+}
+
+void Compiler::visit(const ContinueStmt& stmt) {
+    line = stmt.keyword.line;
+    if (current->loops.empty()) {
+        error("Can't continue outside of a loop.");
+        return;
+    }
+    auto& loop = current->loops.back();
+    discardLocals(loop.scope_depth);
+    if (loop.continue_target != npos) {
+        emitLoop(loop.continue_target);
+    } else {
+        loop.continue_jumps.push_back(emitJump(OpCode::JUMP));
+    }
+}
+
+void Compiler::visit(const VarStmt& stmt) {
+    line = stmt.identifier.line;
+    if (current->scope_depth > 0) {
+        declareLocal(stmt.identifier);
+    }
+
+    if (stmt.initializer) {
+        compile(*stmt.initializer);
+    } else {
+        emit(OpCode::NIL);
+    }
+    defineVariable(stmt.identifier);
+}
+
+void Compiler::visit(const WhileStmt& stmt) {
+    const size_t loop_start = chunk().code.size();
+    compile(*stmt.condition);
+    const size_t exit_jump = emitJump(OpCode::JUMP_IF_FALSE);
+    emit(OpCode::POP);
+
+    current->loops.push_back({current->scope_depth, loop_start, {}, {}});
+    compile(*stmt.body);
+    emitLoop(loop_start);
+
+    patchJump(exit_jump);
+    emit(OpCode::POP);
+
+    for (const auto jump : current->loops.back().break_jumps) {
+        patchJump(jump);
+    }
+    current->loops.pop_back();
+}
+
+void Compiler::visit(const ForStmt& stmt) {
+    beginScope();
+    if (stmt.initializer) {
+        compile(*stmt.initializer);
+    }
+
+    const size_t loop_start = chunk().code.size();
+    size_t exit_jump = npos;
+    if (stmt.condition) {
+        compile(*stmt.condition);
+        exit_jump = emitJump(OpCode::JUMP_IF_FALSE);
+        emit(OpCode::POP);
+    }
+
+    current->loops.push_back({current->scope_depth, npos, {}, {}});
+    compile(*stmt.body);
+
+    for (const auto jump : current->loops.back().continue_jumps) {
+        patchJump(jump);
+    }
+    if (stmt.increment) {
+        compile(*stmt.increment);
+        emit(OpCode::POP);
+    }
+    emitLoop(loop_start);
+
+    if (exit_jump != npos) {
+        patchJump(exit_jump);
+        emit(OpCode::POP);
+    }
+
+    for (const auto jump : current->loops.back().break_jumps) {
+        patchJump(jump);
+    }
+    current->loops.pop_back();
+    endScope();
+}
+
+std::any Compiler::visit(const BinaryExpr& expr) {
+    compile(*expr.left);
+    compile(*expr.right);
+    line = expr.op.line;
+
+    using enum TokenType;
+    switch (expr.op.type) {
+    case PLUS:
+        emit(OpCode::ADD);
+        break;
+    case MINUS:
+        emit(OpCode::SUBTRACT);
+        break;
+    case STAR:
+        emit(OpCode::MULTIPLY);
+        break;
+    case SLASH:
+        emit(OpCode::DIVIDE);
+        break;
+    case GREATER:
+        emit(OpCode::GREATER);
+        break;
+    case GREATER_EQUAL:
+        emit(OpCode::GREATER_EQUAL);
+        break;
+    case LESS:
+        emit(OpCode::LESS);
+        break;
+    case LESS_EQUAL:
+        emit(OpCode::LESS_EQUAL);
+        break;
+    case EQUAL_EQUAL:
+        emit(OpCode::EQUAL);
+        break;
+    case EXCLAMATION_EQUAL:
+        emit(OpCode::NOT_EQUAL);
+        break;
+    default:
+        // Mirror the tree-walker, which evaluates unknown operators to nil.
+        emit(OpCode::POP);
+        emit(OpCode::POP);
+        emit(OpCode::NIL);
+    }
+    return {};
+}
+
+std::any Compiler::visit(const UnaryExpr& expr) {
+    compile(*expr.right);
+    line = expr.op.line;
+
+    switch (expr.op.type) {
+    case TokenType::MINUS:
+        emit(OpCode::NEGATE);
+        break;
+    case TokenType::EXCLAMATION:
+        emit(OpCode::NOT);
+        break;
+    default:
+        emit(OpCode::POP);
+        emit(OpCode::NIL);
+    }
+    return {};
+}
+
+std::any Compiler::visit(const GroupingExpr& expr) {
+    compile(*expr.expression);
+    return {};
+}
+
+std::any Compiler::visit(const LiteralExpr& expr) {
+    if (expr.literal.isNil()) {
+        emit(OpCode::NIL);
+    } else if (expr.literal.isBool()) {
+        emit(expr.literal.asBool() ? OpCode::TRUE : OpCode::FALSE);
+    } else {
+        emitConstant(expr.literal);
+    }
+    return {};
+}
+
+std::any Compiler::visit(const AssignExpr& expr) {
+    compile(*expr.value);
+    namedVariable(expr.identifier, true);
+    return {};
+}
+
+std::any Compiler::visit(const CallExpr& expr) {
+    compileCall(expr, OpCode::CALL);
+    return {};
+}
+
+void Compiler::compileCall(const CallExpr& expr, OpCode op) {
+    compile(*expr.callee);
+    for (const auto& arg : expr.args) {
+        compile(*arg);
+    }
+    line = expr.paren.line;
+    if (expr.args.size() >= max_arguments) {
+        error("Can't have more than 255 arguments.");
+    }
+    emit(op);
+    emitByte(static_cast<uint8_t>(expr.args.size()));
+}
+
+std::any Compiler::visit(const SetExpr&) {
+    emit(OpCode::NIL);
+    return {};
+}
+
+std::any Compiler::visit(const GetExpr&) {
+    emit(OpCode::NIL);
+    return {};
+}
+
+std::any Compiler::visit(const SuperExpr&) {
+    emit(OpCode::NIL);
+    return {};
+}
+
+std::any Compiler::visit(const ThisExpr&) {
+    emit(OpCode::NIL);
+    return {};
+}
+
+std::any Compiler::visit(const LogicalExpr& expr) {
+    compile(*expr.left);
+    line = expr.op.line;
+
+    if (expr.op.type == TokenType::AND) {
+        const size_t end_jump = emitJump(OpCode::JUMP_IF_FALSE);
+        emit(OpCode::POP);
+        compile(*expr.right);
+        patchJump(end_jump);
+    } else {
+        const size_t else_jump = emitJump(OpCode::JUMP_IF_FALSE);
+        const size_t end_jump = emitJump(OpCode::JUMP);
+        patchJump(else_jump);
+        emit(OpCode::POP);
+        compile(*expr.right);
+        patchJump(end_jump);
+    }
+    return {};
+}
+
+std::any Compiler::visit(const VarExpr& expr) {
+    namedVariable(expr.identifier, false);
+    return {};
+}
+
+std::any Compiler::visit(const ListExpr& expr) {
+    line = expr.opening_bracket.line;
+    for (const auto& item : expr.items) {
+        assert(item);
+        compile(*item);
+    }
+    if (expr.items.size() >= max_arguments) {
+        error("Can't have more than 255 items in a list literal.");
+    }
+    emit(OpCode::BUILD_LIST);
+    emitByte(static_cast<uint8_t>(expr.items.size()));
+    return {};
+}
+
+std::any Compiler::visit(const SubscriptExpr& expr) {
+    namedVariable(expr.identifier, false);
+    compile(*expr.index);
+    if (expr.value) {
+        compile(*expr.value);
+    }
+    line = expr.identifier.line;
+    emit(expr.value ? OpCode::SET_INDEX : OpCode::GET_INDEX);
+    emitShort(identifierConstant(expr.identifier));
+    return {};
+}
+
+std::any Compiler::visit(const IncrementExpr& expr) {
+    namedVariable(expr.identifier, false);
+    if (expr.type == IncrementExpr::Type::POSTFIX) {
+        emit(OpCode::DUP);
+    }
+    emit(OpCode::INCREMENT);
+    emitShort(identifierConstant(expr.identifier));
+    namedVariable(expr.identifier, true);
+    if (expr.type == IncrementExpr::Type::POSTFIX) {
+        emit(OpCode::POP);
+    }
+    return {};
+}
+
+std::any Compiler::visit(const DecrementExpr& expr) {
+    namedVariable(expr.identifier, false);
+    if (expr.type == DecrementExpr::Type::POSTFIX) {
+        emit(OpCode::DUP);
+    }
+    emit(OpCode::DECREMENT);
+    emitShort(identifierConstant(expr.identifier));
+    namedVariable(expr.identifier, true);
+    if (expr.type == DecrementExpr::Type::POSTFIX) {
+        emit(OpCode::POP);
+    }
+    return {};
+}
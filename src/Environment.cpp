@@ -1,69 +1,57 @@
 #include "../include/Environment.hpp"
 
-Environment::Environment(std::shared_ptr<Environment> parent_env) : parent_env{std::move(parent_env)} {
-    assert(this->parent_env != nullptr);
-}
-
-Environment::Environment() : parent_env{nullptr} {
-}
-
-void Environment::define(const std::string& identifier, const std::any& value) {
-    // Define a new identifier.
-    values.try_emplace(identifier, std::make_shared<std::any>(value));
-}
-
-void Environment::define(const std::string& identifier, shared_ptr_any ptr_to_val) {
-    // Define a new identifier.
-    values.try_emplace(identifier, ptr_to_val);
+void Environment::define(Symbol identifier, const Value& value) {
+    // Define a new identifier. A script may take over the name of a built-in.
+    const auto [slot, inserted] = values.try_emplace(identifier, value);
+    if (!inserted && slot->second.getType() == Value::Type::NATIVE) {
+        slot->second = value;
+    }
 }
 
-shared_ptr_any Environment::lookup(const Token& identifier) {
+Value& Environment::lookup(const Token& identifier) {
     // Check if the current environment contains the identifier.
-    if (values.contains(identifier.lexeme)) {
+    if (const auto value = values.find(identifier.symbol); value != values.end()) {
         // If so, return the value associated with it.
-        return values[identifier.lexeme];
-    }
-
-    // If the identifier is not in the current environment, check the parent environment until
-    // global scope.
-    if (parent_env) {
-        return parent_env->lookup(identifier);
+        return value->second;
     }
 
-    // If not in global scope, throw error.
-    throw RuntimeError(identifier, "Undefined variable '" + identifier.lexeme + "'.");
+    // Otherwise the variable was never defined.
+    throw RuntimeError(identifier, "Undefined variable '" + std::string{identifier.lexeme()} + "'.");
 }
 
-shared_ptr_any Environment::getAt(size_t distance, const std::string& identifier) {
-    return ancestor(distance)->values[identifier];
+void Environment::define(const Value& value) {
+    slots.push_back(value);
 }
 
-void Environment::assign(const Token& identifier, const std::any& value) {
-    if (values.contains(identifier.lexeme)) {
-        *(values[identifier.lexeme]) = value;
-        return;
-    }
+void Environment::defineCell(const Value& value) {
+    slots.emplace_back(Value::Type::CELL, new Cell{value});
+}
 
-    if (parent_env) {
-        parent_env->assign(identifier, value);
+void Environment::assign(const Token& identifier, const Value& value) {
+    if (const auto old_value = values.find(identifier.symbol); old_value != values.end()) {
+        old_value->second = value;
         return;
     }
 
-    throw RuntimeError(identifier, "Undefined variable '" + identifier.lexeme + "'.");
+    throw RuntimeError(identifier, "Undefined variable '" + std::string{identifier.lexeme()} + "'.");
 }
 
-void Environment::assignAt(size_t distance, const Token& identifier, const std::any& value) {
-    *(ancestor(distance)->values[identifier.lexeme]) = value;
+void Environment::truncate(size_t size) {
+    slots.erase(slots.begin() + static_cast<std::ptrdiff_t>(size), slots.end());
 }
 
-Environment* Environment::ancestor(size_t distance) {
-    auto environment = this;
-    for (size_t i = 0u; i < distance; ++i) {
-        if (!environment->parent_env)
-            break;
-
-        environment = environment->parent_env.get();
+Environment* EnvironmentPool::acquire() {
+    if (free_list.empty()) {
+        return environments.emplace_back(std::make_unique<Environment>()).get();
     }
 
+    Environment* environment = free_list.back();
+    free_list.pop_back();
     return environment;
-}
\ No newline at end of file
+}
+
+void EnvironmentPool::release(Environment* environment) {
+    // Drop the values right away so objects do not outlive their scope.
+    environment->slots.clear();
+    free_list.push_back(environment);
+}
@@ -10,6 +10,10 @@ std::any AssignExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value AssignExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 BinaryExpr::BinaryExpr(unique_expr_ptr left, Token op, unique_expr_ptr right) : left{std::move(left)}, op{std::move(op)}, right{std::move(right)} {
     assert(this->left != nullptr);
     assert(this->right != nullptr);
@@ -19,6 +23,10 @@ std::any BinaryExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value BinaryExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 UnaryExpr::UnaryExpr(Token op, unique_expr_ptr right) : op{std::move(op)}, right{std::move(right)} {
     assert(this->right != nullptr);
 }
@@ -27,6 +35,10 @@ std::any UnaryExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value UnaryExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 IncrementExpr::IncrementExpr(Token variable, Type type) : identifier{std::move(variable)}, type{type} {
     assert(this->identifier.type == TokenType::IDENTIFIER);
 }
@@ -35,6 +47,10 @@ std::any IncrementExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value IncrementExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 DecrementExpr::DecrementExpr(Token variable, Type type) : identifier{std::move(variable)}, type{type} {
     assert(this->identifier.type == TokenType::IDENTIFIER);
 }
@@ -43,6 +59,10 @@ std::any DecrementExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value DecrementExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 CallExpr::CallExpr(unique_expr_ptr callee, Token paren, std::vector<unique_expr_ptr> args) : callee{std::move(callee)}, paren{std::move(paren)}, args{std::move(args)} {
     assert(this->paren.type == TokenType::RIGHT_PAREN);
 }
@@ -51,6 +71,10 @@ std::any CallExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value CallExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 GetExpr::GetExpr(unique_expr_ptr object, Token identifier) : object{std::move(object)}, identifier{std::move(identifier)} {
 }
 
@@ -58,6 +82,10 @@ std::any GetExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value GetExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 SetExpr::SetExpr(unique_expr_ptr object, Token identifier, unique_expr_ptr value) : object{std::move(object)}, identifier{std::move(identifier)}, value{std::move(value)} {
 }
 
@@ -65,6 +93,10 @@ std::any SetExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value SetExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 GroupingExpr::GroupingExpr(unique_expr_ptr expr) : expression{std::move(expr)} {
     assert(this->expression != nullptr);
 }
@@ -73,13 +105,21 @@ std::any GroupingExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
-LiteralExpr::LiteralExpr(std::any literal) : literal{std::move(literal)} {
+Value GroupingExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
+LiteralExpr::LiteralExpr(Value literal) : literal{std::move(literal)} {
 }
 
 std::any LiteralExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value LiteralExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 LogicalExpr::LogicalExpr(unique_expr_ptr left, Token op, unique_expr_ptr right) : left{std::move(left)}, op{std::move(op)}, right{std::move(right)} {
     assert(this->left != nullptr);
     assert(this->right != nullptr);
@@ -90,6 +130,10 @@ std::any LogicalExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value LogicalExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 SuperExpr::SuperExpr(Token keyword, Token method) : keyword{std::move(keyword)}, method{std::move(method)} {
 }
 
@@ -97,6 +141,10 @@ std::any SuperExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value SuperExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 ThisExpr::ThisExpr(Token keyword) : keyword{std::move(keyword)} {
     assert(this->keyword.type == TokenType::THIS);
 }
@@ -105,6 +153,10 @@ std::any ThisExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value ThisExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 VarExpr::VarExpr(Token identifier) : identifier{std::move(identifier)} {
 }
 
@@ -112,6 +164,10 @@ std::any VarExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value VarExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 ListExpr::ListExpr(Token opening_bracket, std::vector<unique_expr_ptr> items) : opening_bracket{std::move(opening_bracket)}, items{std::move(items)} {
 }
 
@@ -119,6 +175,10 @@ std::any ListExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
 
+Value ListExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
+
 SubscriptExpr::SubscriptExpr(Token identifier, unique_expr_ptr index, unique_expr_ptr value) : identifier{std::move(identifier)}, index{std::move(index)}, value{std::move(value)} {
     assert(this->identifier.type == TokenType::IDENTIFIER);
 }
@@ -126,3 +186,7 @@ SubscriptExpr::SubscriptExpr(Token identifier, unique_expr_ptr index, unique_exp
 std::any SubscriptExpr::accept(ExprVisitor<std::any>& visitor) const {
     return visitor.visit(*this);
 }
+
+Value SubscriptExpr::accept(ExprVisitor<Value>& visitor) const {
+    return visitor.visit(*this);
+}
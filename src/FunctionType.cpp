@@ -1,36 +1,84 @@
-
 #include "../include/FunctionType.hpp"
-#include "../include/RuntimeException.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Only immutable values can key the memo or be handed out from it again.
+bool isMemoizable(const Value& value) {
+    return value.getType() <= Value::Type::STRING;
+}
+
+size_t hashValue(const Value& value) noexcept {
+    switch (value.getType()) {
+    case Value::Type::BOOL:
+        return std::hash<bool>{}(value.asBool());
+    case Value::Type::INTEGER:
+        return std::hash<int64_t>{}(value.asInteger());
+    case Value::Type::NUMBER:
+        return std::hash<uint64_t>{}(std::bit_cast<uint64_t>(value.asNumber()));
+    case Value::Type::SHORT_STRING:
+    case Value::Type::STRING:
+        return std::hash<std::string_view>{}(value.asString());
+    default:
+        return 0u;
+    }
+}
+
+// Integers and doubles stay apart too: arithmetic on them can differ in precision.
+bool sameValue(const Value& lhs, const Value& rhs) noexcept {
+    if (lhs.getType() != rhs.getType()) {
+        return false;
+    }
+    if (lhs.getType() == Value::Type::NUMBER) {
+        return std::bit_cast<uint64_t>(lhs.asNumber()) == std::bit_cast<uint64_t>(rhs.asNumber());
+    }
+    return lhs == rhs;
+}
+
+} // namespace
 
-FunctionType::FunctionType(const FnStmt* declaration, std::shared_ptr<Environment> closure) : declaration{declaration}, closure{std::move(closure)} {
+FunctionType::FunctionType(const FnStmt* declaration, std::vector<Value> upvalues) : declaration{declaration}, upvalues{std::move(upvalues)} {
 }
 
 size_t FunctionType::getArity() const{
     return declaration->params.size();
 }
 
-std::any FunctionType::call(Interpreter& interpreter, const std::vector<std::any>& args) const {
-    auto environment = std::make_shared<Environment>(closure);
+Value FunctionType::call(Interpreter& interpreter, std::span<const Value> args) const {
+    if (!declaration->pure || interpreter.memoLimit() == 0u || !std::ranges::all_of(args, isMemoizable)) {
+        return interpreter.executeFunction(*declaration, args, upvalues);
+    }
+
+    if (const auto entry = memo.find(args); entry != memo.end()) {
+        return entry->second;
+    }
+    if (memo.size() >= interpreter.memoLimit()) {
+        return interpreter.executeFunction(*declaration, args, upvalues);
+    }
 
-    for (size_t i = 0u; i < declaration->params.size(); ++i) {
-        // If the argument is of type list or string, define it's owned object in the current
-        // environment.
-        if (args[i].type() == typeid(shared_ptr_any)) {
-            environment->define(declaration->params[i].lexeme, std::any_cast<shared_ptr_any>(args[i]));
-        } else {
-            // Else create a new pointer that doesn't share ownership with the argument.
-            environment->define(declaration->params[i].lexeme, args[i]);
-        }
+    // 'args' lives on the interpreter's argument stack, which the call may reallocate.
+    std::vector<Value> key{args.begin(), args.end()};
+    Value result = interpreter.executeFunction(*declaration, key, upvalues);
+    // Calls made meanwhile may have filled the memo up.
+    if (isMemoizable(result) && memo.size() < interpreter.memoLimit()) {
+        memo.try_emplace(std::move(key), result);
     }
+    return result;
+}
 
-    try {
-        interpreter.executeBlock(declaration->body, std::move(environment));
-    } catch (const ReturnException& return_exception) {
-        return return_exception.getReturnValue();
+size_t FunctionType::ArgumentsHash::operator()(std::span<const Value> args) const noexcept {
+    size_t hash = args.size();
+    for (const auto& arg : args) {
+        hash ^= hashValue(arg) + 0x9e3779b97f4a7c15u + (hash << 6) + (hash >> 2);
     }
-    return {};
+    return hash;
+}
+
+bool FunctionType::ArgumentsEqual::operator()(std::span<const Value> lhs, std::span<const Value> rhs) const noexcept {
+    return std::ranges::equal(lhs, rhs, sameValue);
 }
 
 std::string FunctionType::toString() const {
-    return "<fn " + declaration->identifier.lexeme + ">";
-}
\ No newline at end of file
+    return "<fn " + std::string{declaration->identifier.lexeme()} + ">";
+}
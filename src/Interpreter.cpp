@@ -2,12 +2,25 @@
 #include "../include/Interpreter.hpp"
 #include "../include/BuiltIn.hpp"
 #include "../include/Logger.hpp"
-#include "../include/RuntimeException.hpp"
-
-Interpreter::Interpreter() : global_environment{globals.get()} {
-    globals->define("clock", ClockCallable{});
-    globals->define("print", PrintCallable{});
-    environment = std::move(globals);
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+Interpreter::Interpreter(bool jit, size_t memo_limit)
+    : global_environment{globals.get()}, environment{globals.get()}, memo_limit{memo_limit} {
+    if (jit) {
+        this->jit = std::make_unique<Jit>();
+    }
+    globals->define(Symbols::intern("clock"), Value{Value::Type::NATIVE, new ClockCallable{}});
+    globals->define(Symbols::intern("print"), Value{Value::Type::NATIVE, new PrintCallable{}});
+    globals->define(Symbols::intern("flush"), Value{Value::Type::NATIVE, new FlushCallable{}});
+    globals->define(Symbols::intern("array"), Value{Value::Type::NATIVE, new ArrayCallable{}});
+    globals->define(Symbols::intern("sum"), Value{Value::Type::NATIVE, new SumCallable{}});
+    globals->define(Symbols::intern("min"), Value{Value::Type::NATIVE, new MinCallable{}});
+    globals->define(Symbols::intern("max"), Value{Value::Type::NATIVE, new MaxCallable{}});
+    globals->define(Symbols::intern("dot"), Value{Value::Type::NATIVE, new DotCallable{}});
+    globals->define(Symbols::intern("scale"), Value{Value::Type::NATIVE, new ScaleCallable{}});
+    arguments.reserve(256u);
 }
 
 void Interpreter::interpret(const std::vector<unique_stmt_ptr>& statements) {
@@ -15,14 +28,20 @@ void Interpreter::interpret(const std::vector<unique_stmt_ptr>& statements) {
         for (const auto& stmt : statements) {
             assert(stmt != nullptr);
             execute(*stmt);
+            if (completion != Completion::NORMAL) {
+                break;
+            }
         }
     } catch (const RuntimeError& error) {
         Error::addRuntimeError(error);
-    } catch (const ReturnException&) {
     }
+    arguments.clear();
+    completion = Completion::NORMAL;
+    return_value = Value{};
+    tail_callee = Value{};
 }
 
-std::any Interpreter::evaluate(const Expr& expr) {
+Value Interpreter::evaluate(const Expr& expr) {
     return expr.accept(*this);
 }
 
@@ -30,91 +49,271 @@ void Interpreter::execute(const Stmt& stmt) {
     stmt.accept(*this);
 }
 
-void Interpreter::executeBlock(const std::vector<unique_stmt_ptr>& statements, std::shared_ptr<Environment> enclosing_env) {
-    EnvironmentGuard environment_guard{*this, std::move(enclosing_env)};
+void Interpreter::executeBlock(const std::vector<unique_stmt_ptr>& statements, Environment* frame) {
+    EnvironmentGuard environment_guard{*this, frame};
+    executeStatements(statements);
+}
+
+void Interpreter::executeStatements(const std::vector<unique_stmt_ptr>& statements) {
     for (const auto& statement : statements) {
         assert(statement != nullptr);
         execute(*statement);
+        if (completion != Completion::NORMAL) {
+            return;
+        }
     }
 }
 
-void Interpreter::checkNumberOperand(const Token& op, const std::any& operand) const {
-    if (operand.type() != typeid(double)) {
-        throw RuntimeError(op, "Operand must be a number.");
+// Runs 'body' in the storage the Resolver chose for a block or for loop.
+template <typename Body>
+void Interpreter::executeScope(ScopeLayout layout, Body&& body) {
+    switch (layout) {
+    case ScopeLayout::FRAME: {
+        EnvironmentGuard environment_guard{*this, frames.acquire()};
+        body();
+        break;
+    }
+    case ScopeLayout::SLOTS: {
+        SlotGuard slot_guard{*environment};
+        body();
+        break;
+    }
+    default:
+        body();
+        break;
     }
 }
 
-void Interpreter::checkNumberOperands(const Token& op, const std::any& lhs, const std::any& rhs) const {
-    // Throws a runtime error if either the left-hand side or the right-hand side operand is not of
-    // type double.
-    if (lhs.type() != typeid(double) || rhs.type() != typeid(double)) {
-        throw RuntimeError(op, "Operands must be numbers.");
+// Tail calls do not nest: the returning body leaves the callee in 'tail_callee' and the loop runs
+// it in place of the finished one, so deep tail recursion uses neither native nor frame stack.
+Value Interpreter::executeFunction(const FnStmt& declaration, std::span<const Value> args, std::span<const Value> captured) {
+    const FnStmt* function = &declaration;
+    // Keeps a tail-called function alive while it runs.
+    Value callee;
+    const auto enclosing_upvalues = upvalues;
+
+    while (true) {
+        if (Value result; executeNative(*function, args, result)) {
+            if (!callee.isNil()) {
+                arguments.erase(arguments.end() - static_cast<std::ptrdiff_t>(args.size()), arguments.end());
+            }
+            upvalues = enclosing_upvalues;
+            return result;
+        }
+
+        // Outer locals are only reachable through the captured upvalues.
+        Environment* frame = frames.acquire();
+
+        // Parameters occupy the first slots of the function's frame.
+        for (size_t i = 0u; i < args.size(); ++i) {
+            if (function->param_locations[i].kind == VariableLocation::Kind::CELL) {
+                frame->defineCell(args[i]);
+            } else {
+                frame->define(args[i]);
+            }
+        }
+        if (!callee.isNil()) {
+            arguments.erase(arguments.end() - static_cast<std::ptrdiff_t>(args.size()), arguments.end());
+        }
+
+        upvalues = captured;
+        executeBlock(function->body, frame);
+
+        if (completion != Completion::RETURN) {
+            upvalues = enclosing_upvalues;
+            return {};
+        }
+        completion = Completion::NORMAL;
+        if (tail_callee.isNil()) {
+            upvalues = enclosing_upvalues;
+            return std::exchange(return_value, Value{});
+        }
+
+        callee = std::exchange(tail_callee, Value{});
+        const auto& target = callee.as<FunctionType>();
+        function = &target.getDeclaration();
+        captured = target.getUpvalues();
+        args = std::span<const Value>{arguments}.last(function->params.size());
     }
 }
 
-bool Interpreter::isTruthy(const std::any& object) const {
-    if (!object.has_value()) {
+bool Interpreter::isCompiled(const FnStmt& function) const {
+    return jit != nullptr && jit->compiled(function);
+}
+
+// Runs the machine code of a function once it has been called often enough to be compiled.
+// Returns false when the call has to be interpreted instead.
+bool Interpreter::executeNative(const FnStmt& function, std::span<const Value> args, Value& result) {
+    if (!jit) {
         return false;
     }
-
-    if (object.type() == typeid(bool)) {
-        return std::any_cast<bool>(object);
+    auto& entry = jit->entry(function);
+    if (entry.code == nullptr) {
+        // Compilation is attempted once; a function it fails on or that bails stays interpreted.
+        if (entry.calls > Jit::threshold || ++entry.calls < Jit::threshold) {
+            return false;
+        }
+        ++entry.calls;
+        if (function.location.kind != VariableLocation::Kind::GLOBAL) {
+            return false;
+        }
+        // A memoized mission runs its machine code on memo misses; calls from that code to itself
+        // would bypass the memo.
+        const bool memoized = function.pure && memo_limit > 0u;
+        entry.code = jit->compile(function, global_environment->lookup(function.identifier), !memoized);
+        if (entry.code == nullptr) {
+            return false;
+        }
     }
 
+    // Machine code computes in doubles, which hold integers exactly only below 2^53, and keeps to
+    // the integer results the interpreter would get from integer arguments.
+    constexpr int64_t limit = int64_t{1} << 53;
+    const auto fits = [](const Value& arg) {
+        return arg.isInteger() && arg.asInteger() > -limit && arg.asInteger() < limit;
+    };
+    if (!std::ranges::all_of(args, fits)) {
+        return false;
+    }
+    double number = 0;
+    if (!jit->run(entry.code, args, number)) {
+        entry.code = nullptr;
+        return false;
+    }
+    // The guards keep results whole; anything else is left to the interpreter.
+    if (std::trunc(number) != number || number <= -static_cast<double>(limit) || number >= static_cast<double>(limit)) {
+        return false;
+    }
+    result = static_cast<int64_t>(number);
     return true;
 }
 
-bool Interpreter::isEqual(const std::any& lhs, const std::any& rhs) const {
-    if (!lhs.has_value() && !rhs.has_value()) {
-        return true;
+namespace {
+
+// Evaluates the ordering comparison 'op' of a counted loop.
+template <typename Number>
+bool compare(TokenType op, Number lhs, Number rhs) {
+    switch (op) {
+    case TokenType::LESS:
+        return lhs < rhs;
+    case TokenType::LESS_EQUAL:
+        return lhs <= rhs;
+    case TokenType::GREATER:
+        return lhs > rhs;
+    default:
+        return lhs >= rhs;
     }
-    if (!lhs.has_value()) {
+}
+
+} // namespace
+
+bool Interpreter::executeLoopBody(const Stmt& body) {
+    // Returns false once the loop has to stop iterating.
+    execute(body);
+    switch (completion) {
+    case Completion::BREAK:
+        completion = Completion::NORMAL;
+        return false;
+    case Completion::RETURN:
         return false;
+    case Completion::CONTINUE:
+        completion = Completion::NORMAL;
+        return true;
+    default:
+        return true;
     }
+}
 
-    if (lhs.type() != rhs.type()) {
+// Runs a loop the Optimizer found to only change its counter by a fixed step. The counter is kept
+// aside and stored into the variable for the body to read, while the comparison and the step skip
+// expression evaluation. Returns false without running anything if the counter does not
+// start out as a number, leaving the error to the generic loop.
+bool Interpreter::executeCountedLoop(const ForStmt::CountedLoop& loop, const Stmt& body) {
+    const auto& variable = *loop.counter;
+    const Value& initial = lookUpVariable(variable.identifier, variable.location);
+    if (!initial.isNumber()) {
         return false;
     }
 
-    if (lhs.type() == typeid(bool)) {
-        return std::any_cast<bool>(lhs) == std::any_cast<bool>(rhs);
-    }
+    const BinaryExpr& condition = *loop.condition;
+    const Value step{loop.step};
+    Value counter = initial;
+    while (true) {
+        const Value limit = evaluate(*condition.right);
+        if (!limit.isNumber()) {
+            throw RuntimeError(condition.op, "Operands must be numbers.");
+        }
 
-    if (lhs.type() == typeid(double)) {
-        return std::any_cast<double>(lhs) == std::any_cast<double>(rhs);
-    }
+        bool holds = false;
+        if (counter.isInteger() && limit.isInteger()) {
+            holds = compare(condition.op.type, counter.asInteger(), limit.asInteger());
+        } else {
+            holds = compare(condition.op.type, counter.asNumber(), limit.asNumber());
+        }
+        if (!holds || !executeLoopBody(body)) {
+            return true;
+        }
 
-    if (lhs.type() == typeid(std::string)) {
-        return std::any_cast<std::string>(lhs) == std::any_cast<std::string>(rhs);
+        // The body may have grown the frame, so the slot is looked up again.
+        counter = addNumbers(counter, step);
+        lookUpVariable(variable.identifier, variable.location) = counter;
     }
-    return false;
 }
 
-
-void Interpreter::resolve(const Expr& expr_ptr, size_t distance) {
-    locals.try_emplace(&expr_ptr, distance);
+void Interpreter::checkNumberOperand(const Token& op, const Value& operand) const {
+    if (!operand.isNumber()) {
+        throw RuntimeError(op, "Operand must be a number.");
+    }
 }
 
-shared_ptr_any Interpreter::lookUpVariable(const Token& identifier, const Expr* expr_ptr) const {
-    if (locals.contains(expr_ptr)) {
-        size_t distance = locals.at(expr_ptr);
-        return environment->getAt(distance, identifier.lexeme);
+void Interpreter::checkNumberOperands(const Token& op, const Value& lhs, const Value& rhs) const {
+    // Throws a runtime error if either the left-hand side or the right-hand side operand is not a
+    // number.
+    if (!lhs.isNumber() || !rhs.isNumber()) {
+        throw RuntimeError(op, "Operands must be numbers.");
     }
+}
 
-    return global_environment->lookup(identifier);
+Value& Interpreter::lookUpVariable(const Token& identifier, const VariableLocation& location) const {
+    using enum VariableLocation::Kind;
+    switch (location.kind) {
+    case LOCAL:
+        return environment->at(location.slot);
+    case CELL:
+        return environment->at(location.slot).as<Cell>().value;
+    case UPVALUE:
+        return upvalues[location.slot].as<Cell>().value;
+    default:
+        return global_environment->lookup(identifier);
+    }
 }
 
-void Interpreter::assignVariable(const Expr* expr_ptr, const Token& identifier, const std::any& value) {
+void Interpreter::assignVariable(const VariableLocation& location, const Token& identifier, const Value& value) {
     // Check if the variable is defined in the local scope.
-    if (locals.contains(expr_ptr)) {
-        size_t distance = locals.at(expr_ptr);
-        environment->assignAt(distance, identifier, value);
+    if (location.kind != VariableLocation::Kind::GLOBAL) {
+        lookUpVariable(identifier, location) = value;
     } else {
         // Assign the value to the variable in the global scope.
         global_environment->assign(identifier, value);
     }
 }
 
+void Interpreter::defineVariable(const Token& identifier, const VariableLocation& location, const Value& value) {
+    // Locals are declared in the order the resolver numbered their slots.
+    using enum VariableLocation::Kind;
+    switch (location.kind) {
+    case LOCAL:
+        environment->define(value);
+        break;
+    case CELL:
+        environment->defineCell(value);
+        break;
+    default:
+        global_environment->define(identifier.symbol, value);
+        break;
+    }
+}
+
 void Interpreter::visit(const ExprStmt& stmt) {
     evaluate(*stmt.expression);
 }
@@ -124,25 +323,46 @@ void Interpreter::visit(const PrintStmt& stmt) {
 }
 
 void Interpreter::visit(const BlockStmt& stmt) {
-    executeBlock(stmt.statements, std::make_shared<Environment>(environment));
+    executeScope(stmt.layout, [&] { executeStatements(stmt.statements); });
 }
 
 void Interpreter::visit(const ClassStmt& stmt) {
 }
 
 void Interpreter::visit(const FnStmt& stmt) {
-    environment->define(stmt.identifier.lexeme, FunctionType(&stmt, environment));
+    // A local function may capture itself, so its slot has to exist before the closure is built.
+    const bool local = stmt.location.kind != VariableLocation::Kind::GLOBAL;
+    if (local) {
+        defineVariable(stmt.identifier, stmt.location, Value{});
+    }
+
+    std::vector<Value> captured;
+    captured.reserve(stmt.captures.size());
+    for (const auto& source : stmt.captures) {
+        if (source.kind == VariableLocation::Kind::UPVALUE) {
+            captured.push_back(upvalues[source.slot]);
+        } else {
+            captured.push_back(environment->at(source.slot));
+        }
+    }
+
+    Value function{Value::Type::FUNCTION, new FunctionType(&stmt, std::move(captured))};
+    if (local) {
+        lookUpVariable(stmt.identifier, stmt.location) = std::move(function);
+    } else {
+        defineVariable(stmt.identifier, stmt.location, function);
+    }
 }
 
 void Interpreter::visit(const IfStmt& stmt) {
-    if (isTruthy(evaluate(*stmt.main_branch.condition))) {
+    if (evaluate(*stmt.main_branch.condition).isTruthy()) {
         execute(*stmt.main_branch.statement);
         return;
     }
 
     // Check each elif branch
     for (const auto& elif : stmt.elif_branches) {
-        if (isTruthy(evaluate(*elif.condition))) {
+        if (evaluate(*elif.condition).isTruthy()) {
             execute(*elif.statement);
             return;
         }
@@ -154,151 +374,292 @@ void Interpreter::visit(const IfStmt& stmt) {
 }
 
 void Interpreter::visit(const ReturnStmt& stmt) {
-    std::any value;
-
-    if (stmt.expression) {
+    Value value;
+
+    if (stmt.tail_call) {
+        const auto& call = static_cast<const CallExpr&>(*stmt.expression);
+        auto callee = prepareCall(call);
+        if (callee.getType() == Value::Type::FUNCTION) {
+            // Leave the call to the enclosing executeFunction once this body has unwound.
+            tail_callee = std::move(callee);
+            completion = Completion::RETURN;
+            return;
+        }
+        value = invoke(call, callee, std::span<const Value>{arguments}.last(call.args.size()));
+        arguments.erase(arguments.end() - static_cast<std::ptrdiff_t>(call.args.size()), arguments.end());
+    } else if (stmt.expression) {
         value = evaluate(*stmt.expression);
     }
 
-    throw ReturnException(value);
+    return_value = std::move(value);
+    completion = Completion::RETURN;
 }
 
 void Interpreter::visit(const BreakStmt& stmt) {
-    throw BreakException(stmt.keyword);
+    completion = Completion::BREAK;
 }
 
 void Interpreter::visit(const ContinueStmt& stmt) {
-    throw ContinueException(stmt.keyword);
+    completion = Completion::CONTINUE;
 }
 
 void Interpreter::visit(const VarStmt& stmt) {
-    std::any value;
+    Value value;
     // If the variable has an initializer, evaluate the initializer.
     if (stmt.initializer) {
         value = evaluate(*stmt.initializer);
     }
 
     // Define the variable in the current environment with the given identifier and value
-    environment->define(stmt.identifier.lexeme, value);
+    defineVariable(stmt.identifier, stmt.location, value);
 }
 
 void Interpreter::visit(const WhileStmt& stmt) {
-    while (isTruthy(evaluate(*stmt.condition))) {
-        try {
-            execute(*stmt.body);
-        } catch (const ContinueException&) {
-            // Do nothing.
-        } catch (const BreakException&) {
+    while (evaluate(*stmt.condition).isTruthy()) {
+        if (!executeLoopBody(*stmt.body)) {
             return;
         }
     }
 }
 
 void Interpreter::visit(const ForStmt& stmt) {
-    // Enter a new environment.
-    EnvironmentGuard environment_guard{*this, std::make_shared<Environment>(environment)};
-
-    // If the for loop has an initializer, we execute it.
-    if (stmt.initializer) {
-        execute(*stmt.initializer);
-    }
+    executeScope(stmt.layout, [&] {
+        // If the for loop has an initializer, we execute it.
+        if (stmt.initializer) {
+            execute(*stmt.initializer);
+        }
+        if (stmt.counted && executeCountedLoop(*stmt.counted, *stmt.body)) {
+            return;
+        }
 
-    // No condition can be interpreted as 'while true'.
-    bool no_condition = stmt.condition == nullptr;
+        // No condition can be interpreted as 'while true'.
+        bool no_condition = stmt.condition == nullptr;
 
-    // While the for loop condition is truthy.
-    while (no_condition || isTruthy(evaluate(*stmt.condition))) {
-        try {
+        // While the for loop condition is truthy.
+        while (no_condition || evaluate(*stmt.condition).isTruthy()) {
             // Execute the for loop's body.
-            execute(*stmt.body);
-            // If the for loop has an increment, execute it.
-            if (stmt.increment) {
-                evaluate(*stmt.increment);
+            if (!executeLoopBody(*stmt.body)) {
+                return;
             }
-        } catch (const BreakException&) {
-            return;
-        } catch (const ContinueException&) {
+            // If the for loop has an increment, execute it.
             if (stmt.increment) {
                 evaluate(*stmt.increment);
             }
         }
+    });
+}
+
+namespace {
+
+// The specialization for 'op' that matches the operand types, or GENERIC if there is none.
+BinaryExpr::Quickened quicken(TokenType op, const Value& left, const Value& right) {
+    using enum BinaryExpr::Quickened;
+    if (left.isString() && right.isString()) {
+        return op == TokenType::PLUS ? ADD_STRINGS : GENERIC;
+    }
+    if (!left.isNumber() || !right.isNumber()) {
+        return GENERIC;
+    }
+
+    switch (op) {
+    case TokenType::PLUS:
+        return ADD_NUMBERS;
+    case TokenType::MINUS:
+        return SUBTRACT_NUMBERS;
+    case TokenType::STAR:
+        return MULTIPLY_NUMBERS;
+    case TokenType::SLASH:
+        return DIVIDE_NUMBERS;
+    case TokenType::LESS:
+        return LESS_NUMBERS;
+    case TokenType::LESS_EQUAL:
+        return LESS_EQUAL_NUMBERS;
+    case TokenType::GREATER:
+        return GREATER_NUMBERS;
+    case TokenType::GREATER_EQUAL:
+        return GREATER_EQUAL_NUMBERS;
+    case TokenType::EQUAL_EQUAL:
+        return EQUAL_NUMBERS;
+    case TokenType::EXCLAMATION_EQUAL:
+        return NOT_EQUAL_NUMBERS;
+    default:
+        return GENERIC;
     }
 }
 
-std::any Interpreter::visit(const BinaryExpr& expr) {
-    auto left = evaluate(*expr.left);
-    auto right = evaluate(*expr.right);
+BinaryExpr::Operand operandOf(const Expr& expr) {
+    if (dynamic_cast<const LiteralExpr*>(&expr) != nullptr) {
+        return BinaryExpr::Operand::LITERAL;
+    }
+    if (dynamic_cast<const VarExpr*>(&expr) != nullptr) {
+        return BinaryExpr::Operand::VARIABLE;
+    }
+    return BinaryExpr::Operand::EXPRESSION;
+}
+
+} // namespace
 
-    // Dereference the pointer incase evaluate returns one
-    if (left.type() == typeid(shared_ptr_any)) {
-        left = *(std::any_cast<shared_ptr_any>(left));
+const Value& Interpreter::operand(const Expr& expr, BinaryExpr::Operand kind, Value& storage) {
+    switch (kind) {
+    case BinaryExpr::Operand::LITERAL:
+        return static_cast<const LiteralExpr&>(expr).literal;
+    case BinaryExpr::Operand::VARIABLE: {
+        const auto& variable = static_cast<const VarExpr&>(expr);
+        return lookUpVariable(variable.identifier, variable.location);
     }
+    default:
+        storage = evaluate(expr);
+        return storage;
+    }
+}
 
-    if (right.type() == typeid(shared_ptr_any)) {
-        right = *(std::any_cast<shared_ptr_any>(right));
+// Runs the specialized form of the node when its guard holds; a site that sees new operand types
+// is deoptimized to the generic path for good.
+Value Interpreter::visit(const BinaryExpr& expr) {
+    Value left_storage;
+    Value right_storage;
+    const Value& left = operand(*expr.left, expr.left_operand, left_storage);
+    const Value& right = operand(*expr.right, expr.right_operand, right_storage);
+
+    using enum BinaryExpr::Quickened;
+    const bool numbers = left.isNumber() && right.isNumber();
+    switch (expr.quickened) {
+    case ADD_NUMBERS:
+        if (numbers) {
+            return addNumbers(left, right);
+        }
+        break;
+    case SUBTRACT_NUMBERS:
+        if (numbers) {
+            return subtractNumbers(left, right);
+        }
+        break;
+    case MULTIPLY_NUMBERS:
+        if (numbers) {
+            return multiplyNumbers(left, right);
+        }
+        break;
+    case DIVIDE_NUMBERS:
+        if (numbers && right.asNumber() != 0) {
+            return divideNumbers(left, right);
+        }
+        break;
+    case LESS_NUMBERS:
+        if (numbers) {
+            return lessNumbers(left, right);
+        }
+        break;
+    case LESS_EQUAL_NUMBERS:
+        if (numbers) {
+            return lessEqualNumbers(left, right);
+        }
+        break;
+    case GREATER_NUMBERS:
+        if (numbers) {
+            return lessNumbers(right, left);
+        }
+        break;
+    case GREATER_EQUAL_NUMBERS:
+        if (numbers) {
+            return lessEqualNumbers(right, left);
+        }
+        break;
+    case EQUAL_NUMBERS:
+        if (numbers) {
+            return equalNumbers(left, right);
+        }
+        break;
+    case NOT_EQUAL_NUMBERS:
+        if (numbers) {
+            return !equalNumbers(left, right);
+        }
+        break;
+    case ADD_STRINGS:
+        if (left.isString() && right.isString()) {
+            return concatenate(left, right);
+        }
+        break;
+    case UNSEEN:
+        expr.quickened = quicken(expr.op.type, left, right);
+        expr.right_operand = operandOf(*expr.right);
+        if (expr.right_operand != BinaryExpr::Operand::EXPRESSION) {
+            expr.left_operand = operandOf(*expr.left);
+        }
+        return evaluateBinary(expr, left, right);
+    case GENERIC:
+        return evaluateBinary(expr, left, right);
     }
 
+    expr.quickened = GENERIC;
+    return evaluateBinary(expr, left, right);
+}
+
+Value Interpreter::evaluateBinary(const BinaryExpr& expr, const Value& left, const Value& right) {
     using enum TokenType;
     switch (expr.op.type) {
     case MINUS:
+        if (left.isArray() || right.isArray()) {
+            return evaluateArrays(expr.op, ArrayOperation::SUBTRACT, left, right);
+        }
         checkNumberOperands(expr.op, left, right);
-        return std::any_cast<double>(left) - std::any_cast<double>(right);
+        return subtractNumbers(left, right);
 
     case SLASH:
+        if (left.isArray() || right.isArray()) {
+            return evaluateArrays(expr.op, ArrayOperation::DIVIDE, left, right);
+        }
         checkNumberOperands(expr.op, left, right);
 
         // Throw error if right operand is 0.
-        if (std::any_cast<double>(right) == 0) {
+        if (right.asNumber() == 0) {
             throw RuntimeError(expr.op, "Division by 0.");
         }
-        return std::any_cast<double>(left) / std::any_cast<double>(right);
+        return divideNumbers(left, right);
 
     case STAR:
+        if (left.isArray() || right.isArray()) {
+            return evaluateArrays(expr.op, ArrayOperation::MULTIPLY, left, right);
+        }
         checkNumberOperands(expr.op, left, right);
-        return std::any_cast<double>(left) * std::any_cast<double>(right);
+        return multiplyNumbers(left, right);
 
     case GREATER:
         checkNumberOperands(expr.op, left, right);
-        return std::any_cast<double>(left) > std::any_cast<double>(right);
+        return lessNumbers(right, left);
 
     case GREATER_EQUAL:
         checkNumberOperands(expr.op, left, right);
-        return std::any_cast<double>(left) >= std::any_cast<double>(right);
+        return lessEqualNumbers(right, left);
 
     case LESS:
         checkNumberOperands(expr.op, left, right);
-        return std::any_cast<double>(left) < std::any_cast<double>(right);
+        return lessNumbers(left, right);
 
     case LESS_EQUAL:
         checkNumberOperands(expr.op, left, right);
-        return std::any_cast<double>(left) <= std::any_cast<double>(right);
+        return lessEqualNumbers(left, right);
 
     case EQUAL_EQUAL:
-        return isEqual(left, right);
+        return left == right;
 
     case EXCLAMATION_EQUAL:
-        return !isEqual(left, right);
+        return !(left == right);
 
     case PLUS:
-        if (left.type() == typeid(std::string) && right.type() == typeid(std::string)) {
-            return std::any_cast<std::string>(left) + std::any_cast<std::string>(right);
+        if (left.isNumber() && right.isNumber()) {
+            return addNumbers(left, right);
+        }
+        else if (left.isString() && right.isString()) {
+            return concatenate(left, right);
         }
-        else if (left.type() == typeid(double) && right.type() == typeid(double)) {
-            return std::any_cast<double>(left) + std::any_cast<double>(right);
+        else if (left.isNumber() && right.isString()) {
+            return concatenate(Value{left.toString()}, right);
         }
-        else if (left.type() == typeid(double) && right.type() == typeid(std::string)) {
-            // Remove trailing zeroes.
-            std::string num_as_string = std::to_string(std::any_cast<double>(left));
-            num_as_string.erase(num_as_string.find_last_not_of('0') + 1, std::string::npos);
-            num_as_string.erase(num_as_string.find_last_not_of('.') + 1, std::string::npos);
-            return num_as_string + std::any_cast<std::string>(right);
+        else if (left.isString() && right.isNumber()) {
+            return concatenate(left, Value{right.toString()});
         }
-        else if (left.type() == typeid(std::string) && right.type() == typeid(double)) {
-            // Remove trailing zeroes.
-            std::string num_as_string = std::to_string(std::any_cast<double>(right));
-            num_as_string.erase(num_as_string.find_last_not_of('0') + 1, std::string::npos);
-            num_as_string.erase(num_as_string.find_last_not_of('.') + 1, std::string::npos);
-            return std::any_cast<std::string>(left) + num_as_string;
+        else if (left.isArray() || right.isArray()) {
+            return evaluateArrays(expr.op, ArrayOperation::ADD, left, right);
         }
 
         throw RuntimeError(expr.op, "Operands must be of type string or number.");
@@ -308,14 +669,17 @@ std::any Interpreter::visit(const BinaryExpr& expr) {
     }
 }
 
-std::any Interpreter::visit(const UnaryExpr& expr) {
-    // Evaluate the right-hand side operand of the unary expression.
-    auto right = evaluate(*expr.right);
-
-    // Dereference pointer incase evaluate returns one
-    if (right.type() == typeid(shared_ptr_any)) {
-        right = *(std::any_cast<shared_ptr_any>(right));
+Value Interpreter::evaluateArrays(const Token& op, ArrayOperation operation, const Value& left, const Value& right) const {
+    try {
+        return elementwise(operation, left, right);
+    } catch (const NativeError& error) {
+        throw RuntimeError(op, error.what());
     }
+}
+
+Value Interpreter::visit(const UnaryExpr& expr) {
+    // Evaluate the right-hand side operand of the unary expression.
+    const auto right = evaluate(*expr.right);
 
     // Check the type of the operator
     switch (expr.op.type) {
@@ -323,219 +687,233 @@ std::any Interpreter::visit(const UnaryExpr& expr) {
         // Ensure that the right-hand side operand is a number.
         checkNumberOperand(expr.op, right);
         // Return the negation of the right-hand side operand.
-        return -(std::any_cast<double>(right));
+        return negateNumber(right);
 
     case TokenType::EXCLAMATION:
         // Return the negation of the truthiness of the right-hand side operand.
-        return !isTruthy(right);
+        return !right.isTruthy();
 
     default:
         return {};
     }
 }
 
-std::any Interpreter::visit(const VarExpr& expr) {
+Value Interpreter::visit(const VarExpr& expr) {
     // Retrieve the value associated with the identifier.
-    auto value = lookUpVariable(expr.identifier, &expr);
-
-    // If the value is of type list or string, return the pointer to the object.
-    if (const auto& value_type = std::any_cast<shared_ptr_any>(value)->type();
-        value_type == typeid(std::shared_ptr<List>) || value_type == typeid(std::string)) {
-        return value;
-    }
-
-    // Else return the objects value.
-    return *(std::any_cast<shared_ptr_any>(value));
+    return lookUpVariable(expr.identifier, expr.location);
 }
 
-std::any Interpreter::visit(const GroupingExpr& expr) {
+Value Interpreter::visit(const GroupingExpr& expr) {
     return evaluate(*expr.expression);
 }
 
-std::any Interpreter::visit(const LiteralExpr& expr) {
+Value Interpreter::visit(const LiteralExpr& expr) {
     return expr.literal;
 }
 
-std::any Interpreter::visit(const AssignExpr& expr) {
+Value Interpreter::visit(const AssignExpr& expr) {
     // Evaluate the assigned value.
     auto value = evaluate(*expr.value);
 
     // Assign the new value to the variable.
-    assignVariable(&expr, expr.identifier, value);
+    assignVariable(expr.location, expr.identifier, value);
 
     return value;
 }
 
-std::any Interpreter::visit(const CallExpr& expr) {
+Value Interpreter::visit(const CallExpr& expr) {
+    auto callee = prepareCall(expr);
+    const size_t base = arguments.size() - expr.args.size();
+
+    // Return by calling the function. Callables copy their arguments out before running any code
+    // that may grow the stack again.
+    auto result = invoke(expr, callee, std::span<const Value>{arguments}.subspan(base));
+    arguments.erase(arguments.begin() + static_cast<std::ptrdiff_t>(base), arguments.end());
+    return result;
+}
+
+// Calls 'callee', reporting errors raised by built-ins at the call site.
+Value Interpreter::invoke(const CallExpr& expr, const Value& callee, std::span<const Value> args) {
+    try {
+        return callee.as<Callable>().call(*this, args);
+    } catch (const NativeError& error) {
+        throw RuntimeError(expr.paren, error.what());
+    }
+}
+
+// Evaluates the callee and pushes the arguments on top of 'arguments', checking that the call can
+// be made.
+Value Interpreter::prepareCall(const CallExpr& expr) {
     // Evaluate the callee (the function or class being called).
     auto callee = evaluate(*expr.callee);
 
-    // Collect the arguments passed to the function or class.
-    std::vector<std::any> arguments;
-    arguments.reserve(expr.args.size());
+    // Collect the arguments passed to the function or class on top of the shared argument stack.
+    const size_t base = arguments.size();
     for (const auto& arg : expr.args) {
-        arguments.emplace_back(evaluate(*arg));
+        arguments.push_back(evaluate(*arg));
     }
+    const size_t arg_count = arguments.size() - base;
 
     // Prevent calling objects which are not of callable type.
-    std::unique_ptr<Callable> function;
-    if (callee.type() == typeid(FunctionType)) {
-        function = std::make_unique<FunctionType>(std::any_cast<FunctionType>(callee));
-    }
-    else if (callee.type() == typeid(ClockCallable)) {
-        function = std::make_unique<ClockCallable>();
-    }
-    else if (callee.type() == typeid(PrintCallable)) {
-        function = std::make_unique<PrintCallable>(arguments.size());
-    }
-    else {
+    if (callee.getType() != Value::Type::FUNCTION && callee.getType() != Value::Type::NATIVE) {
         // Throw an error if the callee is not callable (a function or class).
-        throw RuntimeError(expr.paren, expr.paren.lexeme + " is not callable. Callable object must be a function or a class.");
+        throw RuntimeError(expr.paren, std::string{expr.paren.lexeme()} + " is not callable. Callable object must be a function or a class.");
     }
+    const auto& function = callee.as<Callable>();
 
-    // Check that the number of arguments passed to the function or class
-    // matches the expected number
-    if (arguments.size() != function->getArity()) {
-        throw RuntimeError(expr.paren, "Expected " + std::to_string(function->getArity()) + " arguments but got " + std::to_string(arguments.size()) + " .");
+    // The arity check only depends on the callee, so it is skipped while the site keeps calling
+    // the same object.
+    if (&function != expr.cached_callee || function.getArity() != expr.cached_arity) {
+        // Check that the number of arguments passed to the function or class
+        // matches the expected number
+        if (function.getArity() != Callable::variadic && arg_count != function.getArity()) {
+            throw RuntimeError(expr.paren, "Expected " + std::to_string(function.getArity()) + " arguments but got " + std::to_string(arg_count) + " .");
+        }
+        expr.cached_callee = &function;
+        expr.cached_arity = function.getArity();
     }
-
-    // Return by calling the function.
-    return function->call(*this, arguments);
+    return callee;
 }
 
-std::any Interpreter::visit(const GetExpr& expr) {
-    return std::any{};
+Value Interpreter::visit(const GetExpr& expr) {
+    return {};
 }
 
-std::any Interpreter::visit(const SetExpr& expr) {
-    return std::any{};
+Value Interpreter::visit(const SetExpr& expr) {
+    return {};
 }
 
-std::any Interpreter::visit(const SuperExpr& expr) {
-    return std::any{};
+Value Interpreter::visit(const SuperExpr& expr) {
+    return {};
 }
 
-std::any Interpreter::visit(const ThisExpr& expr) {
-    return std::any{};
+Value Interpreter::visit(const ThisExpr& expr) {
+    return {};
 }
 
-std::any Interpreter::visit(const LogicalExpr& expr) {
+Value Interpreter::visit(const LogicalExpr& expr) {
     auto left = evaluate(*expr.left);
     if (expr.op.type == TokenType::OR) {
-        if (isTruthy(left)) {
+        if (left.isTruthy()) {
             return left;
         }
     }
-    else if (!isTruthy(left)) {
+    else if (!left.isTruthy()) {
         return left;
     }
     return evaluate(*expr.right);
 }
 
-std::any Interpreter::visit(const ListExpr& expr) {
-    auto list = std::make_shared<List>();
+Value Interpreter::visit(const ListExpr& expr) {
+    Value list{Value::Type::LIST, new List()};
     for (const auto& item : expr.items) {
         assert(item);
-        list->append(evaluate((*item)));
+        list.as<List>().append(evaluate((*item)));
     }
 
     return list;
 }
 
-std::any Interpreter::visit(const SubscriptExpr& stmt) {
-    // Get the pointer to the list object associated with the provided identifier.
-    auto value_ptr = lookUpVariable(stmt.identifier, &stmt);
+Value Interpreter::visit(const SubscriptExpr& stmt) {
+    // Get the list object associated with the provided identifier.
+    const auto items = lookUpVariable(stmt.identifier, stmt.location);
 
-    // Check if the variable is a list, if not throw a runtime error.
-    if (value_ptr->type() != typeid(std::shared_ptr<List>)) {
-        throw RuntimeError(stmt.identifier, "Object '" + stmt.identifier.lexeme + "' is not subscriptable.");
+    // Check if the variable is a list or an array, if not throw a runtime error.
+    if (!items.isList() && !items.isArray()) {
+        throw RuntimeError(stmt.identifier, "Object '" + std::string{stmt.identifier.lexeme()} + "' is not subscriptable.");
     }
 
-    // Dereference the pointer to access the underlying objects pointer.
-    auto items = *(std::any_cast<shared_ptr_any>(value_ptr));
-
     // Evaluate the index expression.
-    auto index = evaluate(*stmt.index);
-    double index_cast = 0;
-
-    // Refers to the size of the original list object.
-    size_t object_size = 0u;
+    const auto index = evaluate(*stmt.index);
 
-    // Anything else than numbers for indexes are not allowed.
-    if (index.type() == typeid(int)) {
-        index_cast = static_cast<double>(std::any_cast<int>(index));
-    } else if (index.type() == typeid(double)) {
-        index_cast = std::any_cast<double>(index);
-    } else {
+    // Integers are used as they are; a double has to hold a whole number.
+    int64_t position = 0;
+    if (!indexPosition(index, position)) {
         throw RuntimeError(stmt.identifier, "Indices must be integers.");
     }
 
-    // Throw an error if index is not an integer.
-    if (static_cast<int>(index_cast) != index_cast) {
-        throw RuntimeError(stmt.identifier, "Indices must be integers.");
-    }
+    // Refers to the size of the original list object.
+    const auto object_size = static_cast<int64_t>(items.isList() ? items.as<List>().length() : items.as<Array>().length());
 
-    try {
-        auto list = std::any_cast<std::shared_ptr<List>>(items);
-        object_size = list->length();
+    // Allows negative indexes for reverse order.
+    if (position < 0) {
+        position += object_size;
+    }
 
-        // Allows negative indexes for reverse order.
-        if (index_cast < 0) {
-            index_cast = static_cast<int>(list->length()) + index_cast;
-        }
+    if (position < 0 || position >= object_size) {
+        throw RuntimeError(stmt.identifier, "Index out of range. Index is " + std::to_string(position) + " but object size is " + std::to_string(object_size));
+    }
 
-        // If value is associated with the subscript expression, new value will be assigned to the
-        // corresponding index.
+    if (items.isArray()) {
+        auto& element = items.as<Array>().at(static_cast<size_t>(position));
         if (stmt.value) {
-            list->at(index_cast) = evaluate(*stmt.value);
+            const auto value = evaluate(*stmt.value);
+            if (!value.isNumber()) {
+                throw RuntimeError(stmt.identifier, "Array elements must be numbers.");
+            }
+            element = value.asNumber();
         }
-        return list->at(index_cast);
-    } catch (const std::out_of_range&) {
-        throw RuntimeError(stmt.identifier, "Index out of range. Index is " + std::to_string(static_cast<int>(index_cast)) + " but object size is " + std::to_string(object_size));
+        return element;
     }
+
+    auto& list = items.as<List>();
+
+    // If value is associated with the subscript expression, new value will be assigned to the
+    // corresponding index.
+    if (stmt.value) {
+        list.at(static_cast<size_t>(position)) = evaluate(*stmt.value);
+    }
+    return list.at(static_cast<size_t>(position));
 }
 
-std::any Interpreter::visit(const IncrementExpr& expr) {
+Value Interpreter::visit(const IncrementExpr& expr) {
     // Get the current value of the variable that is being incremented.
-    auto old_value = lookUpVariable(expr.identifier, &expr);
+    auto& value = lookUpVariable(expr.identifier, expr.location);
 
-    if (old_value->type() != typeid(double)) {
-        throw RuntimeError(expr.identifier, "Cannot increment a non integer type '" + expr.identifier.lexeme + "'.");
+    if (!value.isNumber()) {
+        throw RuntimeError(expr.identifier, "Cannot increment a non integer type '" + std::string{expr.identifier.lexeme()} + "'.");
     }
 
     // Increment the value by 1.
-    const double new_value = std::any_cast<double>(*old_value) + 1;
-
-    // Update the object being pointed to by.
-    *old_value = std::any_cast<double>(*old_value) + 1;
+    Value old_value = value;
+    value = addNumbers(old_value, Value{int64_t{1}});
 
     // If the expression is a postfix increment, return the old value
     // otherwise return the new value.
-    return expr.type == IncrementExpr::Type::POSTFIX ? new_value - 1 : new_value;
+    return expr.type == IncrementExpr::Type::POSTFIX ? old_value : value;
 }
 
-std::any Interpreter::visit(const DecrementExpr& expr) {
-    // Get the current value of the variable that is being incremented.
-    auto old_value = lookUpVariable(expr.identifier, &expr);
-    if (old_value->type() != typeid(double)) {
-        throw RuntimeError(expr.identifier, "Cannot decrement a non integer type '" + expr.identifier.lexeme + "'.");
+Value Interpreter::visit(const DecrementExpr& expr) {
+    // Get the current value of the variable that is being decremented.
+    auto& value = lookUpVariable(expr.identifier, expr.location);
+    if (!value.isNumber()) {
+        throw RuntimeError(expr.identifier, "Cannot decrement a non integer type '" + std::string{expr.identifier.lexeme()} + "'.");
     }
 
     // Decrement the value by 1.
-    const double new_value = std::any_cast<double>(*old_value) - 1;
-    // Assign the new value to the variable.
-    *old_value = std::any_cast<double>(*old_value) - 1;
-    return expr.type == DecrementExpr::Type::POSTFIX ? new_value + 1 : new_value;
+    Value old_value = value;
+    value = subtractNumbers(old_value, Value{int64_t{1}});
+    return expr.type == DecrementExpr::Type::POSTFIX ? old_value : value;
 }
 
-// When an instance of the class is created, a copy of the current
-// environment is stored, and the current environment is moved to the new one. If a runtime error is
-// encountered and the interpreter needs to unwind the stack and return to the previous environment,
-Interpreter::EnvironmentGuard::EnvironmentGuard(Interpreter& interpreter, std::shared_ptr<Environment> enclosing_env)
+// When an instance of the class is created, the current environment is remembered and 'frame'
+// becomes the current one. If a runtime error is encountered and the interpreter needs to unwind
+// the stack, the frame is still handed back to the pool and the previous environment restored.
+Interpreter::EnvironmentGuard::EnvironmentGuard(Interpreter& interpreter, Environment* frame)
     : interpreter{interpreter}, previous_env{interpreter.environment} {
-    interpreter.environment = std::move(enclosing_env);
+    interpreter.environment = frame;
 }
 
 Interpreter::EnvironmentGuard::~EnvironmentGuard() {
-    interpreter.environment = std::move(previous_env);
+    interpreter.frames.release(interpreter.environment);
+    interpreter.environment = previous_env;
+}
+
+// Remembers how many slots 'frame' holds when a flattened scope is entered and drops the ones the
+// scope appended when it is left, however that happens.
+Interpreter::SlotGuard::SlotGuard(Environment& frame) : frame{frame}, size{frame.size()} {
+}
+
+Interpreter::SlotGuard::~SlotGuard() {
+    frame.truncate(size);
 }
\ No newline at end of file
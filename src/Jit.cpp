@@ -0,0 +1,693 @@
+#include "../include/Jit.hpp"
+#include "../include/ExprNode.hpp"
+#include "../include/FunctionType.hpp"
+#include "../include/Visitor.hpp"
+#include <bit>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define COSMOS_JIT 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef COSMOS_JIT
+namespace {
+
+// Native frames the compiled code may nest before it gives up; deeper recursion is left to the
+// interpreter.
+constexpr uint64_t max_depth = 10000u;
+
+// Guards read the type of a Value from its first byte.
+static_assert(std::is_standard_layout_v<Value>);
+
+// Thrown while compiling a node outside the numeric subset.
+struct Unsupported {};
+
+// Emits machine code into a buffer. Jumps and calls go to labels and are patched once every label
+// is bound.
+class Assembler {
+public:
+    using Label = size_t;
+
+    // Second opcode byte of the 'jcc rel32' forms.
+    enum Condition : uint8_t {
+        BELOW = 0x82,
+        ABOVE_EQUAL = 0x83,
+        EQUAL = 0x84,
+        NOT_EQUAL = 0x85,
+        BELOW_EQUAL = 0x86,
+        ABOVE = 0x87,
+        PARITY = 0x8A
+    };
+
+    Label newLabel() {
+        labels.push_back(unbound);
+        return labels.size() - 1u;
+    }
+
+    void bind(Label label) {
+        labels[label] = code.size();
+    }
+
+    void emit(std::initializer_list<uint8_t> bytes) {
+        code.insert(code.end(), bytes);
+    }
+
+    void imm32(int32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            code.push_back(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i)));
+        }
+    }
+
+    void imm64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    size_t position() const {
+        return code.size();
+    }
+
+    void patch32(size_t position, int32_t value) {
+        std::memcpy(code.data() + position, &value, sizeof(value));
+    }
+
+    void jump(Label label) {
+        emit({0xE9});
+        reference(label);
+    }
+
+    void jumpIf(Condition condition, Label label) {
+        emit({0x0F, condition});
+        reference(label);
+    }
+
+    void call(Label label) {
+        emit({0xE8});
+        reference(label);
+    }
+
+    std::vector<uint8_t> finish() {
+        for (const auto& [position, label] : fixups) {
+            patch32(position, static_cast<int32_t>(labels[label] - (position + 4u)));
+        }
+        return std::move(code);
+    }
+
+private:
+    static constexpr size_t unbound = SIZE_MAX;
+
+    std::vector<uint8_t> code;
+    std::vector<size_t> labels;
+    std::vector<std::pair<size_t, Label>> fixups;
+
+    void reference(Label label) {
+        fixups.emplace_back(code.size(), label);
+        imm32(0);
+    }
+};
+
+// Compiles one mission. Every value is a double kept in xmm0; the left operand of a binary
+// operation waits on the native stack while the right one is computed. Locals live at
+// [rbp - 8 * (slot + 1)] in the slots the Resolver assigned.
+//
+// Native calling convention: rdi points at the arguments, pushed in order so that parameter i
+// of n is at [rdi + 8 * (n - 1 - i)]. The result is returned in xmm0.
+class FunctionCompiler : public ExprVisitor<std::any>, public StmtVisitor {
+public:
+    FunctionCompiler(const FnStmt& function, const Value& binding, bool self_calls, void* bailed, void* depth)
+        : function{function}, binding{&binding}, object{binding.objectAddress()}, self{static_cast<const Object*>(&binding.as<FunctionType>())},
+          self_calls{self_calls}, bailed{bailed}, depth{depth} {}
+
+    std::vector<uint8_t> compile() {
+        entry = as.newLabel();
+        body = as.newLabel();
+        bail = as.newLabel();
+        leave = as.newLabel();
+
+        // push rbp; mov rbp, rsp; sub rsp, frame size
+        as.bind(entry);
+        as.emit({0x55, 0x48, 0x89, 0xE5, 0x48, 0x81, 0xEC});
+        const size_t frame_size = as.position();
+        as.imm32(0);
+
+        // Give up on recursion deeper than max_depth.
+        loadAddress(depth);
+        as.emit({0x48, 0xFF, 0x00, 0x48, 0x81, 0x38});
+        as.imm32(static_cast<int32_t>(max_depth));
+        as.jumpIf(Assembler::ABOVE, bail);
+
+        const size_t arity = function.params.size();
+        for (size_t i = 0u; i < arity; ++i) {
+            // movsd xmm0, [rdi + disp32]
+            as.emit({0xF2, 0x0F, 0x10, 0x87});
+            as.imm32(static_cast<int32_t>(8u * (arity - 1u - i)));
+            store(0u, parameterSlot(i));
+        }
+
+        as.bind(body);
+        for (const auto& stmt : function.body) {
+            stmt->accept(*this);
+        }
+        // Falling off the end returns nil, which is not a double.
+        as.jump(bail);
+
+        as.bind(bail);
+        loadAddress(bailed);
+        as.emit({0x48, 0xC7, 0x00});
+        as.imm32(1);
+        as.bind(leave);
+        as.emit({0xC9, 0xC3});
+
+        as.patch32(frame_size, static_cast<int32_t>((8u * slot_count + 15u) & ~size_t{15u}));
+        return as.finish();
+    }
+
+    std::any visit(const BinaryExpr& expr) override {
+        using enum TokenType;
+        switch (expr.op.type) {
+        case PLUS:
+        case MINUS:
+        case STAR:
+        case SLASH:
+            break;
+        default:
+            throw Unsupported{};
+        }
+
+        operands(expr);
+        switch (expr.op.type) {
+        case PLUS:
+            as.emit({0xF2, 0x0F, 0x58, 0xC1}); // addsd xmm0, xmm1
+            break;
+        case MINUS:
+            as.emit({0xF2, 0x0F, 0x5C, 0xC1}); // subsd xmm0, xmm1
+            break;
+        case STAR:
+            as.emit({0xF2, 0x0F, 0x59, 0xC1}); // mulsd xmm0, xmm1
+            break;
+        case SLASH: {
+            // Division by zero is a runtime error the interpreter reports.
+            const auto divide = as.newLabel();
+            as.emit({0x66, 0x0F, 0x57, 0xD2, 0x66, 0x0F, 0x2E, 0xCA}); // xorpd xmm2, xmm2; ucomisd xmm1, xmm2
+            as.jumpIf(Assembler::PARITY, divide);
+            as.jumpIf(Assembler::EQUAL, bail);
+            as.bind(divide);
+            as.emit({0xF2, 0x0F, 0x5E, 0xC1}); // divsd xmm0, xmm1
+            // A quotient with a fraction is where the interpreter switches to doubles.
+            // cvttsd2si rax, xmm0; cvtsi2sd xmm2, rax; ucomisd xmm0, xmm2; jne bail
+            as.emit({0xF2, 0x48, 0x0F, 0x2C, 0xC0, 0xF2, 0x48, 0x0F, 0x2A, 0xD0, 0x66, 0x0F, 0x2E, 0xC2});
+            as.jumpIf(Assembler::NOT_EQUAL, bail);
+            break;
+        }
+        default:
+            break;
+        }
+
+        integerGuard();
+        return {};
+    }
+
+    std::any visit(const UnaryExpr& expr) override {
+        if (expr.op.type != TokenType::MINUS) {
+            throw Unsupported{};
+        }
+        expr.right->accept(*this);
+        constant(0x8000000000000000u, 1u);
+        as.emit({0x66, 0x0F, 0x57, 0xC1}); // xorpd xmm0, xmm1
+        integerGuard();
+        return {};
+    }
+
+    std::any visit(const GroupingExpr& expr) override {
+        return expr.expression->accept(*this);
+    }
+
+    std::any visit(const LiteralExpr& expr) override {
+        if (!expr.literal.isInteger()) {
+            throw Unsupported{};
+        }
+        constant(std::bit_cast<uint64_t>(expr.literal.asNumber()), 0u);
+        return {};
+    }
+
+    std::any visit(const AssignExpr& expr) override {
+        expr.value->accept(*this);
+        store(0u, localSlot(expr.location));
+        return {};
+    }
+
+    std::any visit(const CallExpr& expr) override {
+        if (!self_calls) {
+            throw Unsupported{};
+        }
+        selfCallArguments(expr);
+        // mov rdi, rsp
+        as.emit({0x48, 0x89, 0xE7});
+        as.call(entry);
+        // add rsp, imm32
+        as.emit({0x48, 0x81, 0xC4});
+        as.imm32(static_cast<int32_t>(8u * expr.args.size()));
+
+        // A callee that gave up has set 'bailed'; unwind without touching it.
+        loadAddress(bailed);
+        as.emit({0x48, 0x83, 0x38, 0x00});
+        as.jumpIf(Assembler::NOT_EQUAL, leave);
+        return {};
+    }
+
+    std::any visit(const VarExpr& expr) override {
+        load(0u, localSlot(expr.location));
+        return {};
+    }
+
+    std::any visit(const IncrementExpr& expr) override {
+        step(localSlot(expr.location), expr.type == IncrementExpr::Type::PREFIX, 0x58);
+        return {};
+    }
+
+    std::any visit(const DecrementExpr& expr) override {
+        step(localSlot(expr.location), expr.type == DecrementExpr::Type::PREFIX, 0x5C);
+        return {};
+    }
+
+    std::any visit(const SetExpr& expr) override { throw Unsupported{}; }
+    std::any visit(const GetExpr& expr) override { throw Unsupported{}; }
+    std::any visit(const SuperExpr& expr) override { throw Unsupported{}; }
+    std::any visit(const LogicalExpr& expr) override { throw Unsupported{}; }
+    std::any visit(const ThisExpr& expr) override { throw Unsupported{}; }
+    std::any visit(const ListExpr& expr) override { throw Unsupported{}; }
+    std::any visit(const SubscriptExpr& expr) override { throw Unsupported{}; }
+
+    void visit(const BlockStmt& stmt) override {
+        for (const auto& statement : stmt.statements) {
+            statement->accept(*this);
+        }
+    }
+
+    void visit(const ExprStmt& stmt) override {
+        stmt.expression->accept(*this);
+    }
+
+    void visit(const IfStmt& stmt) override {
+        const auto end = as.newLabel();
+        branch(stmt.main_branch, end);
+        for (const auto& elif : stmt.elif_branches) {
+            branch(elif, end);
+        }
+        if (stmt.else_branch) {
+            stmt.else_branch->accept(*this);
+        }
+        as.bind(end);
+    }
+
+    void visit(const ReturnStmt& stmt) override {
+        if (!stmt.expression) {
+            throw Unsupported{};
+        }
+
+        if (stmt.tail_call) {
+            // Overwrite the parameters and start the body over instead of calling.
+            const auto& call = static_cast<const CallExpr&>(*stmt.expression);
+            selfCallArguments(call);
+            for (size_t i = call.args.size(); i-- > 0u;) {
+                pop();
+                store(0u, parameterSlot(i));
+            }
+            as.jump(body);
+            return;
+        }
+
+        stmt.expression->accept(*this);
+        loadAddress(depth);
+        as.emit({0x48, 0xFF, 0x08, 0xC9, 0xC3}); // dec qword [rax]; leave; ret
+    }
+
+    void visit(const BreakStmt& stmt) override {
+        as.jump(loops.back().exit);
+    }
+
+    void visit(const ContinueStmt& stmt) override {
+        as.jump(loops.back().next);
+    }
+
+    void visit(const VarStmt& stmt) override {
+        if (!stmt.initializer) {
+            throw Unsupported{};
+        }
+        stmt.initializer->accept(*this);
+        store(0u, localSlot(stmt.location));
+    }
+
+    void visit(const WhileStmt& stmt) override {
+        const Loop loop{as.newLabel(), as.newLabel()};
+        as.bind(loop.next);
+        jumpIf(*stmt.condition, false, loop.exit);
+        loops.push_back(loop);
+        stmt.body->accept(*this);
+        loops.pop_back();
+        as.jump(loop.next);
+        as.bind(loop.exit);
+    }
+
+    void visit(const ForStmt& stmt) override {
+        if (stmt.initializer) {
+            stmt.initializer->accept(*this);
+        }
+
+        const auto condition = as.newLabel();
+        const Loop loop{as.newLabel(), as.newLabel()};
+        as.bind(condition);
+        if (stmt.condition) {
+            jumpIf(*stmt.condition, false, loop.exit);
+        }
+        loops.push_back(loop);
+        stmt.body->accept(*this);
+        loops.pop_back();
+
+        as.bind(loop.next);
+        if (stmt.increment) {
+            stmt.increment->accept(*this);
+        }
+        as.jump(condition);
+        as.bind(loop.exit);
+    }
+
+    void visit(const ClassStmt& stmt) override { throw Unsupported{}; }
+    void visit(const FnStmt& stmt) override { throw Unsupported{}; }
+    void visit(const PrintStmt& stmt) override { throw Unsupported{}; }
+
+private:
+    struct Loop {
+        Assembler::Label next; // where 'continue' goes
+        Assembler::Label exit;
+    };
+
+    const FnStmt& function;
+    const Value* binding;
+    const void* object;
+    const void* self;
+    bool self_calls;
+    void* bailed;
+    void* depth;
+
+    Assembler as;
+    Assembler::Label entry = 0u;
+    Assembler::Label body = 0u;
+    Assembler::Label bail = 0u;
+    Assembler::Label leave = 0u;
+    std::vector<Loop> loops;
+    uint32_t slot_count = 0u;
+
+    uint32_t localSlot(const VariableLocation& location) {
+        if (location.kind != VariableLocation::Kind::LOCAL) {
+            throw Unsupported{};
+        }
+        slot_count = std::max(slot_count, location.slot + 1u);
+        return location.slot;
+    }
+
+    uint32_t parameterSlot(size_t index) {
+        return localSlot(function.param_locations[index]);
+    }
+
+    static int32_t displacement(uint32_t slot) {
+        return -8 * static_cast<int32_t>(slot + 1u);
+    }
+
+    // movsd xmm<reg>, [rbp + disp32]
+    void load(uint8_t reg, uint32_t slot) {
+        as.emit({0xF2, 0x0F, 0x10, static_cast<uint8_t>(0x85 | reg << 3)});
+        as.imm32(displacement(slot));
+    }
+
+    // movsd [rbp + disp32], xmm<reg>
+    void store(uint8_t reg, uint32_t slot) {
+        as.emit({0xF2, 0x0F, 0x11, static_cast<uint8_t>(0x85 | reg << 3)});
+        as.imm32(displacement(slot));
+    }
+
+    // mov rax, bits; movq xmm<reg>, rax
+    void constant(uint64_t bits, uint8_t reg) {
+        as.emit({0x48, 0xB8});
+        as.imm64(bits);
+        as.emit({0x66, 0x48, 0x0F, 0x6E, static_cast<uint8_t>(0xC0 | reg << 3)});
+    }
+
+    // Doubles only match the interpreter's integer arithmetic below 2^53, and a -0 result is
+    // where the interpreter switches to doubles.
+    void integerGuard() {
+        // movq rax, xmm0; mov rcx, -0; cmp rax, rcx; je bail
+        as.emit({0x66, 0x48, 0x0F, 0x7E, 0xC0, 0x48, 0xB9});
+        as.imm64(0x8000000000000000u);
+        as.emit({0x48, 0x39, 0xC8});
+        as.jumpIf(Assembler::EQUAL, bail);
+        // btr rax, 63; mov rcx, 2^53; cmp rax, rcx; jae bail
+        as.emit({0x48, 0x0F, 0xBA, 0xF0, 0x3F, 0x48, 0xB9});
+        as.imm64(std::bit_cast<uint64_t>(0x1p53));
+        as.emit({0x48, 0x39, 0xC8});
+        as.jumpIf(Assembler::ABOVE_EQUAL, bail);
+    }
+
+    void loadAddress(const void* address) {
+        as.emit({0x48, 0xB8});
+        as.imm64(reinterpret_cast<uint64_t>(address));
+    }
+
+    // sub rsp, 8; movsd [rsp], xmm0
+    void push() {
+        as.emit({0x48, 0x83, 0xEC, 0x08, 0xF2, 0x0F, 0x11, 0x04, 0x24});
+    }
+
+    // movsd xmm0, [rsp]; add rsp, 8
+    void pop() {
+        as.emit({0xF2, 0x0F, 0x10, 0x04, 0x24, 0x48, 0x83, 0xC4, 0x08});
+    }
+
+    // Leaves the left operand in xmm0 and the right one in xmm1.
+    void operands(const BinaryExpr& expr) {
+        expr.left->accept(*this);
+        push();
+        expr.right->accept(*this);
+        as.emit({0xF2, 0x0F, 0x10, 0xC8}); // movsd xmm1, xmm0
+        pop();
+    }
+
+    // Adds (0x58) or subtracts (0x5C) one, leaving the old or new value in xmm0.
+    void step(uint32_t slot, bool prefix, uint8_t operation) {
+        load(0u, slot);
+        constant(std::bit_cast<uint64_t>(1.0), 2u);
+        as.emit({0xF2, 0x0F, 0x10, 0xC8, 0xF2, 0x0F, operation, 0xC2}); // movsd xmm1, xmm0; op xmm0, xmm2
+        integerGuard();
+        store(0u, slot);
+        if (!prefix) {
+            as.emit({0xF2, 0x0F, 0x10, 0xC1}); // movsd xmm0, xmm1
+        }
+    }
+
+    // Pushes the arguments of a call the mission makes to itself, after checking the global
+    // variable it calls through still holds it.
+    void selfCallArguments(const CallExpr& call) {
+        const auto* callee = dynamic_cast<const VarExpr*>(call.callee.get());
+        if (callee == nullptr || callee->location.kind != VariableLocation::Kind::GLOBAL ||
+            callee->identifier.symbol != function.identifier.symbol || call.args.size() != function.params.size()) {
+            throw Unsupported{};
+        }
+
+        // mov rax, binding; cmp byte [rax], FUNCTION; jne bail
+        loadAddress(binding);
+        as.emit({0x80, 0x38, static_cast<uint8_t>(Value::Type::FUNCTION)});
+        as.jumpIf(Assembler::NOT_EQUAL, bail);
+        // mov rax, object; mov rax, [rax]; mov rcx, self; cmp rax, rcx; jne bail
+        loadAddress(object);
+        as.emit({0x48, 0x8B, 0x00, 0x48, 0xB9});
+        as.imm64(reinterpret_cast<uint64_t>(self));
+        as.emit({0x48, 0x39, 0xC8});
+        as.jumpIf(Assembler::NOT_EQUAL, bail);
+
+        for (const auto& arg : call.args) {
+            arg->accept(*this);
+            push();
+        }
+    }
+
+    void branch(const IfBranch& branch, Assembler::Label end) {
+        const auto next = as.newLabel();
+        jumpIf(*branch.condition, false, next);
+        branch.statement->accept(*this);
+        as.jump(end);
+        as.bind(next);
+    }
+
+    // Jumps to 'target' if the truthiness of 'condition' is 'when'.
+    void jumpIf(const Expr& condition, bool when, Assembler::Label target) {
+        using enum TokenType;
+        if (const auto* grouping = dynamic_cast<const GroupingExpr*>(&condition)) {
+            jumpIf(*grouping->expression, when, target);
+            return;
+        }
+        if (const auto* unary = dynamic_cast<const UnaryExpr*>(&condition); unary != nullptr && unary->op.type == EXCLAMATION) {
+            jumpIf(*unary->right, !when, target);
+            return;
+        }
+        if (const auto* logical = dynamic_cast<const LogicalExpr*>(&condition)) {
+            // 'a and b' is falsy as soon as a is, 'a or b' truthy as soon as a is.
+            const bool decided_by_left = logical->op.type == OR;
+            if (when == decided_by_left) {
+                jumpIf(*logical->left, when, target);
+                jumpIf(*logical->right, when, target);
+            } else {
+                const auto skip = as.newLabel();
+                jumpIf(*logical->left, decided_by_left, skip);
+                jumpIf(*logical->right, when, target);
+                as.bind(skip);
+            }
+            return;
+        }
+        if (const auto* literal = dynamic_cast<const LiteralExpr*>(&condition); literal != nullptr && literal->literal.isBool()) {
+            if (literal->literal.asBool() == when) {
+                as.jump(target);
+            }
+            return;
+        }
+
+        const auto* binary = dynamic_cast<const BinaryExpr*>(&condition);
+        if (binary == nullptr || binary->op.type == PLUS || binary->op.type == MINUS || binary->op.type == STAR || binary->op.type == SLASH) {
+            // Numbers are always truthy.
+            condition.accept(*this);
+            if (when) {
+                as.jump(target);
+            }
+            return;
+        }
+
+        operands(*binary);
+        constexpr uint8_t left_right[] = {0x66, 0x0F, 0x2E, 0xC1}; // ucomisd xmm0, xmm1
+        constexpr uint8_t right_left[] = {0x66, 0x0F, 0x2E, 0xC8}; // ucomisd xmm1, xmm0
+        const auto compare = [&](const uint8_t (&bytes)[4]) {
+            as.emit({bytes[0], bytes[1], bytes[2], bytes[3]});
+        };
+        // Unordered operands (NaN) set ZF, PF and CF, so every test below fails for them.
+        switch (binary->op.type) {
+        case LESS:
+            compare(right_left);
+            as.jumpIf(when ? Assembler::ABOVE : Assembler::BELOW_EQUAL, target);
+            break;
+        case LESS_EQUAL:
+            compare(right_left);
+            as.jumpIf(when ? Assembler::ABOVE_EQUAL : Assembler::BELOW, target);
+            break;
+        case GREATER:
+            compare(left_right);
+            as.jumpIf(when ? Assembler::ABOVE : Assembler::BELOW_EQUAL, target);
+            break;
+        case GREATER_EQUAL:
+            compare(left_right);
+            as.jumpIf(when ? Assembler::ABOVE_EQUAL : Assembler::BELOW, target);
+            break;
+        case EQUAL_EQUAL:
+        case EXCLAMATION_EQUAL: {
+            compare(left_right);
+            if (when == (binary->op.type == EQUAL_EQUAL)) {
+                const auto skip = as.newLabel();
+                as.jumpIf(Assembler::PARITY, skip);
+                as.jumpIf(Assembler::EQUAL, target);
+                as.bind(skip);
+            } else {
+                as.jumpIf(Assembler::PARITY, target);
+                as.jumpIf(Assembler::NOT_EQUAL, target);
+            }
+            break;
+        }
+        default:
+            throw Unsupported{};
+        }
+    }
+};
+
+} // namespace
+
+Jit::Jit() : runtime{std::make_unique<Runtime>()} {
+}
+
+Jit::~Jit() {
+    for (const auto& [address, size] : regions) {
+        munmap(address, size);
+    }
+}
+
+Jit::NativeFunction Jit::compile(const FnStmt& function, const Value& binding, bool self_calls) {
+    if (function.location.kind != VariableLocation::Kind::GLOBAL || !function.captures.empty() || binding.getType() != Value::Type::FUNCTION ||
+        &binding.as<FunctionType>().getDeclaration() != &function) {
+        return nullptr;
+    }
+
+    std::vector<uint8_t> code;
+    try {
+        FunctionCompiler compiler{function, binding, self_calls, &runtime->bailed, &runtime->depth};
+        code = compiler.compile();
+    } catch (const Unsupported&) {
+        return nullptr;
+    }
+
+    // Write the code, then make it executable but no longer writable.
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t size = (code.size() + page - 1u) / page * page;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    regions.emplace_back(memory, size);
+    functions.push_back(binding);
+    return reinterpret_cast<NativeFunction>(memory);
+}
+
+bool Jit::compiled(const FnStmt& function) const {
+    const auto found = entries.find(&function);
+    return found != entries.end() && found->second.code != nullptr;
+}
+
+bool Jit::run(NativeFunction code, std::span<const Value> args, double& result) {
+    // Arguments in push order: the last one at the lowest address.
+    std::vector<double> stack(args.size());
+    for (size_t i = 0u; i < args.size(); ++i) {
+        stack[args.size() - 1u - i] = args[i].asNumber();
+    }
+
+    result = code(stack.data());
+    const bool bailed = runtime->bailed != 0u;
+    runtime->bailed = 0u;
+    runtime->depth = 0u;
+    return !bailed;
+}
+
+#else
+
+// Other platforms keep interpreting every mission.
+Jit::Jit() : runtime{std::make_unique<Runtime>()} {
+}
+
+Jit::~Jit() = default;
+
+Jit::NativeFunction Jit::compile(const FnStmt&, const Value&, bool) {
+    return nullptr;
+}
+
+bool Jit::run(NativeFunction, std::span<const Value>, double&) {
+    return false;
+}
+
+bool Jit::compiled(const FnStmt&) const {
+    return false;
+}
+
+#endif
@@ -1,27 +1,40 @@
 #include "../include/Lexer.hpp"
 #include "../include/Logger.hpp"
-
-const std::unordered_map<std::string, TokenType> Lexer::keywords{
-    {"and", TokenType::AND},      {"or", TokenType::OR},
-    {"nova", TokenType::NOVA},  {"probe", TokenType::PROBE},
-    {"blackhole", TokenType::BLACKHOLE},    {"elprobe", TokenType::ELPROBE},
-    {"void", TokenType::VOID}, {"cosmic", TokenType::COSMIC},
-    {"mission", TokenType::MISSION},        {"navigate", TokenType::NAVIGATE},
-    {"orbit", TokenType::ORBIT},  {"nil", TokenType::NIL},
-    {"flare", TokenType::FLARE},  {"transmit", TokenType::TRANSMIT},
-    {"supernova", TokenType::SUPERNOVA},  {"this", TokenType::THIS},
-    {"atom", TokenType::ATOM},      {"lambda", TokenType::LAMBDA},
-    {"eject", TokenType::EJECT},  {"warp", TokenType::WARP}};
-
-Lexer::Lexer(std::string source) : source{std::move(source)} {
-}
-
-std::vector<Token> Lexer::scanTokens() {
+#include <utility>
+
+const std::unordered_map<Symbol, TokenType> Lexer::keywords{
+    {Symbols::intern("and"), TokenType::AND},      {Symbols::intern("or"), TokenType::OR},
+    {Symbols::intern("nova"), TokenType::NOVA},  {Symbols::intern("probe"), TokenType::PROBE},
+    {Symbols::intern("blackhole"), TokenType::BLACKHOLE},    {Symbols::intern("elprobe"), TokenType::ELPROBE},
+    {Symbols::intern("void"), TokenType::VOID}, {Symbols::intern("cosmic"), TokenType::COSMIC},
+    {Symbols::intern("mission"), TokenType::MISSION},        {Symbols::intern("navigate"), TokenType::NAVIGATE},
+    {Symbols::intern("orbit"), TokenType::ORBIT},  {Symbols::intern("nil"), TokenType::NIL},
+    {Symbols::intern("flare"), TokenType::FLARE},  {Symbols::intern("transmit"), TokenType::TRANSMIT},
+    {Symbols::intern("supernova"), TokenType::SUPERNOVA},  {Symbols::intern("this"), TokenType::THIS},
+    {Symbols::intern("atom"), TokenType::ATOM},      {Symbols::intern("lambda"), TokenType::LAMBDA},
+    {Symbols::intern("eject"), TokenType::EJECT},  {Symbols::intern("warp"), TokenType::WARP}};
+
+Lexer::Lexer(std::string_view source) : source{source}, first{Sources::add(source)} {
+}
+
+// Scans until one token is produced, skipping whitespace and comments. Keeps returning _EOF once
+// the source is exhausted.
+Token Lexer::nextToken() {
     while (!isEOF()) {
         start = current;
         scanToken();
+        if (scanned) {
+            return *std::exchange(scanned, std::nullopt);
+        }
     }
-    tokens.emplace_back(TokenType::_EOF, "", line);
+    return Token{TokenType::_EOF, first + static_cast<uint32_t>(source.size()), 0u, line};
+}
+
+std::vector<Token> Lexer::scanTokens() {
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(nextToken());
+    } while (tokens.back().type != TokenType::_EOF);
     return tokens;
 }
 
@@ -118,8 +131,9 @@ void Lexer::identifier() {
         advance();
     }
 
-    const std::string text = source.substr(start, current - start);
-    addToken(keywords.contains(text) ? keywords.at(text) : TokenType::IDENTIFIER);
+    const Symbol symbol = Symbols::intern(source.substr(start, current - start));
+    const auto keyword = keywords.find(symbol);
+    addToken(keyword != keywords.end() ? keyword->second : TokenType::IDENTIFIER, symbol);
 }
 
 void Lexer::number() {
@@ -188,10 +202,12 @@ void Lexer::advance() {
     current++;
 }
 
-std::string Lexer::getLexeme(TokenType type) const {
+std::string_view Lexer::getLexeme(TokenType type) const {
     return (type == TokenType::STRING) ? source.substr(start + 1, current - start - 2) : source.substr(start, current - start);
 }
 
-void Lexer::addToken(const TokenType type) {
-    tokens.emplace_back(type, getLexeme(type), line);
+void Lexer::addToken(const TokenType type, Symbol symbol) {
+    const auto lexeme = getLexeme(type);
+    const auto offset = static_cast<uint32_t>(lexeme.data() - source.data());
+    scanned.emplace(type, first + offset, static_cast<uint32_t>(lexeme.size()), line, symbol);
 }
@@ -1,23 +1,23 @@
 #include "../include/ListType.hpp"
 #include "../include/RuntimeError.hpp"
 
-List::List(std::vector<std::any> values) : values{std::move(values)}, len{this->values.size()} {
+List::List(std::vector<Value> values) : values{std::move(values)}, len{this->values.size()} {
 }
 
 size_t List::length() const noexcept {
     return len;
 }
 
-std::any& List::at(int index) {
+Value& List::at(int index) {
     return index < 0 ? values.at(len + index) : values.at(index);
 }
 
-void List::append(const std::any& value) {
+void List::append(const Value& value) {
     values.push_back(value);
     len += 1;
 }
 
-std::any List::pop() noexcept {
+Value List::pop() noexcept {
     const auto value = values.back();
     values.pop_back();
     len -= 1;
@@ -33,3 +33,18 @@ void List::remove(int index) {
     }
     len -= 1;
 }
+
+std::string List::toString() const {
+    std::string result;
+    appendTo(result);
+    return result;
+}
+
+void List::appendTo(std::string& out) const {
+    out += '[';
+    for (size_t i = 0u; i < len; ++i) {
+        out += (i == 0u) ? " " : ", ";
+        values[i].appendTo(out);
+    }
+    out += " ]";
+}
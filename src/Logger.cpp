@@ -19,7 +19,7 @@ namespace Error {
         if (token.type == TokenType::_EOF) {
             exceptionList.emplace_back(token.line, "at end", std::move(message));
         } else {
-            exceptionList.emplace_back(token.line, "at '" + token.lexeme + "'", std::move(message));
+            exceptionList.emplace_back(token.line, "at '" + std::string{token.lexeme()} + "'", std::move(message));
         }
         hadError = true;
     }
@@ -0,0 +1,350 @@
+#include "../include/Optimizer.hpp"
+#include <algorithm>
+#include <optional>
+#include <span>
+
+namespace {
+
+// The visitors hand out const nodes, but the optimizer owns the tree it rewrites.
+Expr* release(const unique_expr_ptr& expr) {
+    return const_cast<unique_expr_ptr&>(expr).release();
+}
+
+LiteralExpr* literal(const unique_expr_ptr& expr) {
+    return dynamic_cast<LiteralExpr*>(expr.get());
+}
+
+// Only integer literals are identities: a double one would turn an integer operand into a double.
+bool isNumber(const LiteralExpr* expr, int64_t number) {
+    return expr != nullptr && expr->literal.isInteger() && expr->literal.asInteger() == number;
+}
+
+// Whether evaluating 'expr' either fails or yields a number, so an identity applied to it can go.
+bool producesNumber(const Expr& expr) {
+    using enum TokenType;
+    if (const auto* literal = dynamic_cast<const LiteralExpr*>(&expr)) {
+        return literal->literal.isNumber();
+    }
+    if (const auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+        // Arithmetic on an array gives an array.
+        const bool arithmetic = binary->op.type == MINUS || binary->op.type == STAR || binary->op.type == SLASH;
+        return arithmetic && producesNumber(*binary->left) && producesNumber(*binary->right);
+    }
+    if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+        return unary->op.type == MINUS;
+    }
+    return dynamic_cast<const IncrementExpr*>(&expr) != nullptr || dynamic_cast<const DecrementExpr*>(&expr) != nullptr;
+}
+
+// Computes 'lhs op rhs' the way both engines do, or nothing when that would be a runtime error.
+std::optional<Value> fold(TokenType op, const Value& lhs, const Value& rhs) {
+    using enum TokenType;
+    switch (op) {
+    case EQUAL_EQUAL:
+        return Value{lhs == rhs};
+    case EXCLAMATION_EQUAL:
+        return Value{!(lhs == rhs)};
+    case PLUS:
+        if (lhs.isString() && rhs.isString()) {
+            return concatenate(lhs, rhs);
+        }
+        if (lhs.isNumber() && rhs.isString()) {
+            return concatenate(Value{lhs.toString()}, rhs);
+        }
+        if (lhs.isString() && rhs.isNumber()) {
+            return concatenate(lhs, Value{rhs.toString()});
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (!lhs.isNumber() || !rhs.isNumber()) {
+        return std::nullopt;
+    }
+    switch (op) {
+    case PLUS:
+        return addNumbers(lhs, rhs);
+    case MINUS:
+        return subtractNumbers(lhs, rhs);
+    case STAR:
+        return multiplyNumbers(lhs, rhs);
+    case SLASH:
+        if (rhs.asNumber() == 0) {
+            return std::nullopt;
+        }
+        return divideNumbers(lhs, rhs);
+    case GREATER:
+        return Value{lessNumbers(rhs, lhs)};
+    case GREATER_EQUAL:
+        return Value{lessEqualNumbers(rhs, lhs)};
+    case LESS:
+        return Value{lessNumbers(lhs, rhs)};
+    case LESS_EQUAL:
+        return Value{lessEqualNumbers(lhs, rhs)};
+    default:
+        return std::nullopt;
+    }
+}
+
+bool isComparison(TokenType op) {
+    using enum TokenType;
+    return op == LESS || op == LESS_EQUAL || op == GREATER || op == GREATER_EQUAL;
+}
+
+// How much 'increment' changes 'counter' by when it is 'counter++' or 'counter--' in either form,
+// otherwise 0.
+int64_t stepOf(const Expr* increment, Symbol counter) {
+    if (const auto* expr = dynamic_cast<const IncrementExpr*>(increment); expr != nullptr && expr->identifier.symbol == counter) {
+        return 1;
+    }
+    if (const auto* expr = dynamic_cast<const DecrementExpr*>(increment); expr != nullptr && expr->identifier.symbol == counter) {
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace
+
+void Optimizer::optimize(std::vector<unique_stmt_ptr>& statements) {
+    for (const auto& stmt : statements) {
+        optimize(stmt);
+    }
+}
+
+void Optimizer::optimize(const unique_stmt_ptr& stmt) {
+    if (stmt) {
+        stmt->accept(*this);
+    }
+}
+
+void Optimizer::optimize(const unique_expr_ptr& expr) {
+    if (!expr) {
+        return;
+    }
+    auto replacement = expr->accept(*this);
+    if (replacement.has_value()) {
+        const_cast<unique_expr_ptr&>(expr).reset(std::any_cast<Expr*>(replacement));
+    }
+}
+
+std::any Optimizer::visit(const BinaryExpr& expr) {
+    optimize(expr.left);
+    optimize(expr.right);
+
+    auto* left = literal(expr.left);
+    auto* right = literal(expr.right);
+    if (left != nullptr && right != nullptr) {
+        auto folded = fold(expr.op.type, left->literal, right->literal);
+        if (!folded) {
+            return {};
+        }
+        left->literal = std::move(*folded);
+        return release(expr.left);
+    }
+
+    // x * 1, 1 * x, x / 1 and x - 0 are x itself once x is known to be a number. x + 0 is not:
+    // it turns -0 into 0.
+    using enum TokenType;
+    switch (expr.op.type) {
+    case STAR:
+        if (isNumber(right, 1) && producesNumber(*expr.left)) {
+            return release(expr.left);
+        }
+        if (isNumber(left, 1) && producesNumber(*expr.right)) {
+            return release(expr.right);
+        }
+        break;
+    case SLASH:
+        if (isNumber(right, 1) && producesNumber(*expr.left)) {
+            return release(expr.left);
+        }
+        break;
+    case MINUS:
+        if (isNumber(right, 0) && producesNumber(*expr.left)) {
+            return release(expr.left);
+        }
+        break;
+    default:
+        break;
+    }
+    return {};
+}
+
+std::any Optimizer::visit(const UnaryExpr& expr) {
+    optimize(expr.right);
+
+    if (auto* right = literal(expr.right)) {
+        if (expr.op.type == TokenType::MINUS && right->literal.isNumber()) {
+            right->literal = negateNumber(right->literal);
+            return release(expr.right);
+        }
+        if (expr.op.type == TokenType::EXCLAMATION) {
+            right->literal = !right->literal.isTruthy();
+            return release(expr.right);
+        }
+        return {};
+    }
+
+    // -(-x) is x for numbers.
+    const auto* inner = dynamic_cast<const UnaryExpr*>(expr.right.get());
+    if (expr.op.type == TokenType::MINUS && inner != nullptr && inner->op.type == TokenType::MINUS && producesNumber(*inner->right)) {
+        return release(inner->right);
+    }
+    return {};
+}
+
+std::any Optimizer::visit(const GroupingExpr& expr) {
+    optimize(expr.expression);
+    return release(expr.expression);
+}
+
+std::any Optimizer::visit(const LiteralExpr& expr) {
+    return {};
+}
+
+std::any Optimizer::visit(const AssignExpr& expr) {
+    optimize(expr.value);
+    assigned.push_back(expr.identifier.symbol);
+    return {};
+}
+
+std::any Optimizer::visit(const CallExpr& expr) {
+    optimize(expr.callee);
+    for (const auto& arg : expr.args) {
+        optimize(arg);
+    }
+    return {};
+}
+
+std::any Optimizer::visit(const SetExpr& expr) {
+    return {};
+}
+
+std::any Optimizer::visit(const GetExpr& expr) {
+    return {};
+}
+
+std::any Optimizer::visit(const SuperExpr& expr) {
+    return {};
+}
+
+std::any Optimizer::visit(const LogicalExpr& expr) {
+    optimize(expr.left);
+    optimize(expr.right);
+
+    // A literal on the left decides which operand the expression evaluates to.
+    const auto* left = literal(expr.left);
+    if (left == nullptr) {
+        return {};
+    }
+    const bool short_circuits = expr.op.type == TokenType::OR ? left->literal.isTruthy() : !left->literal.isTruthy();
+    return short_circuits ? release(expr.left) : release(expr.right);
+}
+
+std::any Optimizer::visit(const ThisExpr& expr) {
+    return {};
+}
+
+std::any Optimizer::visit(const VarExpr& expr) {
+    return {};
+}
+
+std::any Optimizer::visit(const ListExpr& expr) {
+    for (const auto& item : expr.items) {
+        optimize(item);
+    }
+    return {};
+}
+
+std::any Optimizer::visit(const SubscriptExpr& expr) {
+    optimize(expr.index);
+    optimize(expr.value);
+    return {};
+}
+
+std::any Optimizer::visit(const IncrementExpr& expr) {
+    assigned.push_back(expr.identifier.symbol);
+    return {};
+}
+
+std::any Optimizer::visit(const DecrementExpr& expr) {
+    assigned.push_back(expr.identifier.symbol);
+    return {};
+}
+
+void Optimizer::visit(const BlockStmt& stmt) {
+    for (const auto& statement : stmt.statements) {
+        optimize(statement);
+    }
+}
+
+void Optimizer::visit(const ClassStmt& stmt) {
+}
+
+void Optimizer::visit(const ExprStmt& stmt) {
+    optimize(stmt.expression);
+}
+
+void Optimizer::visit(const FnStmt& stmt) {
+    for (const auto& statement : stmt.body) {
+        optimize(statement);
+    }
+}
+
+void Optimizer::visit(const IfStmt& stmt) {
+    optimize(stmt.main_branch.condition);
+    optimize(stmt.main_branch.statement);
+
+    for (const auto& elif : stmt.elif_branches) {
+        optimize(elif.condition);
+        optimize(elif.statement);
+    }
+
+    optimize(stmt.else_branch);
+}
+
+void Optimizer::visit(const PrintStmt& stmt) {
+    optimize(stmt.expression);
+}
+
+void Optimizer::visit(const ReturnStmt& stmt) {
+    optimize(stmt.expression);
+}
+
+void Optimizer::visit(const BreakStmt& stmt) {
+}
+
+void Optimizer::visit(const ContinueStmt& stmt) {
+}
+
+void Optimizer::visit(const VarStmt& stmt) {
+    optimize(stmt.initializer);
+}
+
+void Optimizer::visit(const WhileStmt& stmt) {
+    optimize(stmt.condition);
+    optimize(stmt.body);
+}
+
+void Optimizer::visit(const ForStmt& stmt) {
+    optimize(stmt.initializer);
+    const size_t first_assignment = assigned.size();
+    optimize(stmt.condition);
+    optimize(stmt.body);
+    const auto body_assignments = std::span{assigned}.subspan(first_assignment);
+
+    stmt.counted.reset();
+    const auto* counter = dynamic_cast<const VarStmt*>(stmt.initializer.get());
+    const auto* condition = dynamic_cast<const BinaryExpr*>(stmt.condition.get());
+    if (counter != nullptr && counter->initializer && condition != nullptr && isComparison(condition->op.type)) {
+        const Symbol name = counter->identifier.symbol;
+        const auto* compared = dynamic_cast<const VarExpr*>(condition->left.get());
+        const int64_t step = stepOf(stmt.increment.get(), name);
+        if (compared != nullptr && compared->identifier.symbol == name && step != 0 && std::ranges::find(body_assignments, name) == body_assignments.end()) {
+            stmt.counted = ForStmt::CountedLoop{counter, condition, step};
+        }
+    }
+
+    optimize(stmt.increment);
+}
@@ -0,0 +1,42 @@
+#include "../include/Output.hpp"
+#include <iostream>
+
+Output& Output::standard() {
+    static Output output;
+    return output;
+}
+
+Output::Output() {
+    buffer.reserve(capacity);
+}
+
+Output::~Output() {
+    flush();
+}
+
+void Output::setPolicy(FlushPolicy policy) {
+    this->policy = policy;
+}
+
+void Output::append(const Value& value) {
+    value.appendTo(buffer);
+}
+
+void Output::append(char character) {
+    buffer += character;
+}
+
+void Output::endLine() {
+    buffer += '\n';
+    if (policy == FlushPolicy::LINE || (policy == FlushPolicy::SIZE && buffer.size() >= capacity)) {
+        flush();
+    }
+}
+
+void Output::flush() {
+    if (!buffer.empty()) {
+        std::cout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    std::cout.flush();
+}
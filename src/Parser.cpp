@@ -1,15 +1,16 @@
 #include "../include/Parser.hpp"
+#include <charconv>
 #define void_cast(x) (static_cast<void>(x))
 
-Parser::Parser(std::vector<Token> tokens) : tokens{std::move(tokens)} {
+Parser::Parser(Lexer& lexer) : lexer{lexer}, current{lexer.nextToken()}, previous_token{current} {
 }
 
-std::vector<unique_stmt_ptr> Parser::parse() {
+Program Parser::parse() {
     std::vector<unique_stmt_ptr> statements;
     while (!isAtEnd()) {
         statements.emplace_back(declaration());
     }
-    return statements;
+    return Program{std::move(arena), std::move(statements)};
 }
 
 unique_stmt_ptr Parser::statement() {
@@ -24,7 +25,7 @@ unique_stmt_ptr Parser::statement() {
     if (match({TokenType::ORBIT}))
         return whileStatement();
     if (match({TokenType::LEFT_BRACE}))
-        return std::make_unique<BlockStmt>(block());
+        return make<BlockStmt>(block());
     if (match({TokenType::EJECT, TokenType::WARP}))
         return controlStatement();
 
@@ -36,10 +37,10 @@ unique_stmt_ptr Parser::controlStatement() {
     unique_stmt_ptr stmt;
     if (token.type == TokenType::EJECT) {
         void_cast(consume(TokenType::SEMICOLON, "Expect ';' after break."));
-        stmt = std::make_unique<BreakStmt>(std::move(token));
+        stmt = make<BreakStmt>(std::move(token));
     } else if (token.type == TokenType::WARP) {
         void_cast(consume(TokenType::SEMICOLON, "Expect ';' after continue)."));
-        stmt = std::make_unique<ContinueStmt>(std::move(token));
+        stmt = make<ContinueStmt>(std::move(token));
     }
     return stmt;
 }
@@ -70,7 +71,7 @@ unique_stmt_ptr Parser::forStatement() {
     auto increment = forExpression(TokenType::RIGHT_PAREN, "Expect ')' after for clauses.");
     auto body = statement();
 
-    return std::make_unique<ForStmt>(std::move(initializer), std::move(condition), std::move(increment), std::move(body));
+    return make<ForStmt>(std::move(initializer), std::move(condition), std::move(increment), std::move(body));
 }
 
 unique_stmt_ptr Parser::ifStatement() {
@@ -94,7 +95,7 @@ unique_stmt_ptr Parser::ifStatement() {
     if (match({TokenType::BLACKHOLE})) {
         else_branch = statement();
     }
-    return std::make_unique<IfStmt>(std::move(main_branch), std::move(elif_branches), std::move(else_branch));
+    return make<IfStmt>(std::move(main_branch), std::move(elif_branches), std::move(else_branch));
 }
 
 unique_stmt_ptr Parser::declaration() {
@@ -116,10 +117,10 @@ unique_stmt_ptr Parser::printStatement() {
     if (!match({TokenType::LEFT_PAREN})) {
         throw error(identifier, "Expect '(' after 'print'.");
     }
-    auto expr = finishCall(std::make_unique<VarExpr>(std::move(identifier)));
+    auto expr = finishCall(make<VarExpr>(std::move(identifier)));
     void_cast(consume(TokenType::SEMICOLON, "Expect ';' after print statement."));
 
-    return std::make_unique<PrintStmt>(std::move(expr));
+    return make<PrintStmt>(std::move(expr));
 }
 
 unique_stmt_ptr Parser::returnStatement() {
@@ -130,7 +131,7 @@ unique_stmt_ptr Parser::returnStatement() {
     }
 
     void_cast(consume(TokenType::SEMICOLON, "Expect ';' after return value."));
-    return std::make_unique<ReturnStmt>(std::move(keyword), std::move(value));
+    return make<ReturnStmt>(std::move(keyword), std::move(value));
 }
 
 unique_stmt_ptr Parser::varDeclaration() {
@@ -138,7 +139,7 @@ unique_stmt_ptr Parser::varDeclaration() {
     auto initializer = match({TokenType::EQUAL}) ? expression() : nullptr;
 
     void_cast(consume(TokenType::SEMICOLON, "Expect ';' after variable declaration."));
-    return std::make_unique<VarStmt>(std::move(identifier), std::move(initializer));
+    return make<VarStmt>(std::move(identifier), std::move(initializer));
 }
 
 unique_stmt_ptr Parser::whileStatement() {
@@ -147,13 +148,13 @@ unique_stmt_ptr Parser::whileStatement() {
     void_cast(consume(TokenType::RIGHT_PAREN, "Expect a ')' after 'while'."));
     auto body = statement();
 
-    return std::make_unique<WhileStmt>(std::move(condition), std::move(body));
+    return make<WhileStmt>(std::move(condition), std::move(body));
 }
 
 unique_stmt_ptr Parser::expressionStatement() {
     auto expr = expression();
     void_cast(consume(TokenType::SEMICOLON, "Expect ';' after value."));
-    return std::make_unique<ExprStmt>(std::move(expr));
+    return make<ExprStmt>(std::move(expr));
 }
 
 unique_stmt_ptr Parser::function(const std::string& kind) {
@@ -175,7 +176,7 @@ unique_stmt_ptr Parser::function(const std::string& kind) {
 
     auto body = block();
 
-    return std::make_unique<FnStmt>(std::move(identifier), std::move(params), std::move(body));
+    return make<FnStmt>(std::move(identifier), std::move(params), std::move(body));
 }
 
 std::vector<unique_stmt_ptr> Parser::block()
@@ -202,14 +203,14 @@ unique_expr_ptr Parser::assignment()
         // Check if the left-hand side of the assign expression is a regular identifier.
         if (dynamic_cast<VarExpr*>(expr.get()))
         {
-            return std::make_unique<AssignExpr>(
-                std::move(dynamic_cast<VarExpr*>(expr.release())->identifier), std::move(value));
+            return make<AssignExpr>(
+                std::move(dynamic_cast<VarExpr*>(expr.get())->identifier), std::move(value));
         }
 
         // Check if the left-hand side expression is a subscript expression.
-        if (auto subscript_ptr = dynamic_cast<SubscriptExpr*>(expr.release()))
+        if (auto subscript_ptr = dynamic_cast<SubscriptExpr*>(expr.get()))
         {
-            return std::make_unique<SubscriptExpr>(std::move(subscript_ptr->identifier), std::move(subscript_ptr->index), std::move(value));
+            return make<SubscriptExpr>(std::move(subscript_ptr->identifier), std::move(subscript_ptr->index), std::move(value));
         }
 
         // Otherwise throw error.
@@ -235,7 +236,7 @@ unique_expr_ptr Parser::orExpression()
     {
         auto op = previous();
         auto right = andExpression();
-        expr = std::make_unique<LogicalExpr>(std::move(expr), std::move(op), std::move(right));
+        expr = make<LogicalExpr>(std::move(expr), std::move(op), std::move(right));
     }
 
     return expr;
@@ -249,7 +250,7 @@ unique_expr_ptr Parser::andExpression()
     {
         auto op = previous();
         auto right = andExpression();
-        expr = std::make_unique<LogicalExpr>(std::move(expr), std::move(op), std::move(right));
+        expr = make<LogicalExpr>(std::move(expr), std::move(op), std::move(right));
     }
 
     return expr;
@@ -269,7 +270,7 @@ unique_expr_ptr Parser::binary(Fn func, const std::initializer_list<TokenType>&
     {
         auto op = previous();
         auto right = func();
-        expr = std::make_unique<BinaryExpr>(std::move(expr), std::move(op), std::move(right));
+        expr = make<BinaryExpr>(std::move(expr), std::move(op), std::move(right));
     }
 
     return expr;
@@ -304,7 +305,7 @@ unique_expr_ptr Parser::unary()
         auto op = previous();
         auto right = unary();
 
-        return std::make_unique<UnaryExpr>(std::move(op), std::move(right));
+        return make<UnaryExpr>(std::move(op), std::move(right));
     }
 
     return prefix();
@@ -325,11 +326,11 @@ unique_expr_ptr Parser::prefix()
 
         if (op.type == TokenType::PLUS_PLUS)
         {
-            return std::make_unique<IncrementExpr>(std::move(lvalue), IncrementExpr::Type::PREFIX);
+            return make<IncrementExpr>(std::move(lvalue), IncrementExpr::Type::PREFIX);
         }
         else
         {
-            return std::make_unique<DecrementExpr>(std::move(lvalue), DecrementExpr::Type::PREFIX);
+            return make<DecrementExpr>(std::move(lvalue), DecrementExpr::Type::PREFIX);
         }
     }
 
@@ -357,13 +358,13 @@ unique_expr_ptr Parser::postfix()
 
         if (op.type == TokenType::PLUS_PLUS)
         {
-            expr = std::make_unique<IncrementExpr>(
-                dynamic_cast<VarExpr*>(expr.release())->identifier, IncrementExpr::Type::POSTFIX);
+            expr = make<IncrementExpr>(
+                dynamic_cast<VarExpr*>(expr.get())->identifier, IncrementExpr::Type::POSTFIX);
         }
         else
         {
-            expr = std::make_unique<DecrementExpr>(
-                dynamic_cast<VarExpr*>(expr.release())->identifier, DecrementExpr::Type::POSTFIX);
+            expr = make<DecrementExpr>(
+                dynamic_cast<VarExpr*>(expr.get())->identifier, DecrementExpr::Type::POSTFIX);
         }
     }
 
@@ -388,7 +389,7 @@ unique_expr_ptr Parser::finishCall(unique_expr_ptr callee)
 
     auto paren = consume(TokenType::RIGHT_PAREN, "Except ')' after arguments.");
 
-    return std::make_unique<CallExpr>(std::move(callee), std::move(paren), std::move(arguments));
+    return make<CallExpr>(std::move(callee), std::move(paren), std::move(arguments));
 }
 
 unique_expr_ptr Parser::call()
@@ -421,9 +422,9 @@ unique_expr_ptr Parser::finishSubscript(unique_expr_ptr identifier)
         throw error(peek(), "Object is not subscriptable.");
     }
 
-    auto var = dynamic_cast<VarExpr*>(identifier.release())->identifier;
+    auto var = dynamic_cast<VarExpr*>(identifier.get())->identifier;
 
-    return std::make_unique<SubscriptExpr>(std::move(var), std::move(index), nullptr);
+    return make<SubscriptExpr>(std::move(var), std::move(index), nullptr);
 }
 
 unique_expr_ptr Parser::subscript()
@@ -479,32 +480,41 @@ unique_expr_ptr Parser::primary()
 
     if (match({NUMBER}))
     {
-        return std::make_unique<LiteralExpr>(std::strtod(previous().lexeme.c_str(), nullptr));
+        const auto lexeme = previous().lexeme();
+        // Whole numbers start out as integers unless they are too large for one.
+        int64_t integer = 0;
+        const auto [end, error] = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), integer);
+        if (error == std::errc{} && end == lexeme.data() + lexeme.size()) {
+            return make<LiteralExpr>(integer);
+        }
+        double number = 0.0;
+        std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), number);
+        return make<LiteralExpr>(number);
     }
 
     if (match({STRING}))
     {
-        return std::make_unique<LiteralExpr>(previous().lexeme);
+        return make<LiteralExpr>(std::string{previous().lexeme()});
     }
 
     if (match({VOID}))
     {
-        return std::make_unique<LiteralExpr>(false);
+        return make<LiteralExpr>(false);
     }
 
     if (match({COSMIC}))
     {
-        return std::make_unique<LiteralExpr>(true);
+        return make<LiteralExpr>(true);
     }
 
     if (match({NIL}))
     {
-        return std::make_unique<LiteralExpr>(std::any{});
+        return make<LiteralExpr>(Value{});
     }
 
     if (match({IDENTIFIER}))
     {
-        return std::make_unique<VarExpr>(previous());
+        return make<VarExpr>(previous());
     }
 
     if (match({LEFT_PAREN}))
@@ -512,7 +522,7 @@ unique_expr_ptr Parser::primary()
         auto expr = expression();
         void_cast(consume(RIGHT_PAREN, "Expect ')' after expression."));
 
-        return std::make_unique<GroupingExpr>(std::move(expr));
+        return make<GroupingExpr>(std::move(expr));
     }
 
     if (match({LEFT_BRACKET}))
@@ -521,7 +531,7 @@ unique_expr_ptr Parser::primary()
         auto expr = list();
         void_cast(consume(TokenType::RIGHT_BRACKET, "Expect ']' at the end of a list."));
 
-        return std::make_unique<ListExpr>(std::move(opening_bracket), std::move(expr));
+        return make<ListExpr>(std::move(opening_bracket), std::move(expr));
     }
 
     throw error(peek(), "Expect expression.");
@@ -552,7 +562,8 @@ bool Parser::check(TokenType type) const {
 
 void Parser::advance() {
     if (!isAtEnd()) {
-        current++;
+        previous_token = current;
+        current = lexer.nextToken();
     }
 }
 
@@ -561,11 +572,11 @@ bool Parser::isAtEnd() const {
 }
 
 const Token& Parser::peek() const {
-    return tokens[current];
+    return current;
 }
 
 Token Parser::previous() const {
-    return tokens[current - 1];
+    return previous_token;
 }
 
 Parser::ParseError Parser::error(const Token& token, std::string msg) const {
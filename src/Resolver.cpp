@@ -1,8 +1,20 @@
 #include "../include/Resolver.hpp"
 #include "../include/Logger.hpp"
+#include <algorithm>
 
-Resolver::Resolver(Interpreter& interpreter) : interpreter{interpreter} {
-    func_stack.push(FuncType::NONE);
+namespace {
+
+// Only statements directly in a scope declare into it; nested blocks get scopes of their own.
+bool declaresVariables(const std::vector<unique_stmt_ptr>& statements) {
+    return std::ranges::any_of(statements, [](const unique_stmt_ptr& stmt) {
+        return dynamic_cast<const VarStmt*>(stmt.get()) != nullptr || dynamic_cast<const FnStmt*>(stmt.get()) != nullptr;
+    });
+}
+
+} // namespace
+
+Resolver::Resolver() {
+    functions.push_back({FuncType::NONE, nullptr, 0u, {}, 0u, false, false, {}});
 }
 
 void Resolver::resolve(const std::vector<unique_stmt_ptr>& statements) {
@@ -10,6 +22,10 @@ void Resolver::resolve(const std::vector<unique_stmt_ptr>& statements) {
         assert(stmt);
         resolve(*stmt);
     }
+    // Function bodies and blocks are resolved through here too; purity needs the whole program.
+    if (functions.size() == 1u && scopes.empty()) {
+        resolvePurity();
+    }
 }
 
 void Resolver::resolve(const Stmt& stmt) {
@@ -20,30 +36,125 @@ void Resolver::resolve(const Expr& expr) {
     expr.accept(*this);
 }
 
-void Resolver::resolveLocal(const Expr* expr, const Token& identifier) {
-    if (scopes.empty())
-        return;
-    for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
-        if (scope->contains(identifier.lexeme)) {
-            interpreter.resolve(*expr, std::distance(scopes.rbegin(), scope));
-            return;
+// Records on the node where the variable lives, so evaluating it needs no further lookup.
+void Resolver::resolveLocal(VariableLocation& location, const Token& identifier) {
+    location = VariableLocation{};
+    for (size_t scope = scopes.size(); scope-- > 0u;) {
+        const auto variable = scopes[scope].find(identifier.symbol);
+        if (variable == scopes[scope].end()) {
+            continue;
         }
+
+        if (scope >= functions.back().scope_base) {
+            location.kind = variable->second.captured ? VariableLocation::Kind::CELL : VariableLocation::Kind::LOCAL;
+            location.slot = variable->second.slot;
+            variable->second.uses.push_back(&location);
+        } else {
+            // Declared in an enclosing function, so the closure has to capture it.
+            location.kind = VariableLocation::Kind::UPVALUE;
+            location.slot = resolveUpvalue(functions.size() - 1u, scope, variable->second);
+        }
+        return;
+    }
+}
+
+// Returns the index of 'variable' among the upvalues of 'function', adding it (and threading it
+// through every function in between) on first use.
+uint32_t Resolver::resolveUpvalue(size_t function, size_t scope, Variable& variable) {
+    auto& upvalues = functions[function].upvalues;
+    if (const auto upvalue = std::ranges::find(upvalues, &variable); upvalue != upvalues.end()) {
+        return static_cast<uint32_t>(std::distance(upvalues.begin(), upvalue));
+    }
+
+    // The closure is created in the frame of the enclosing function, which holds all its locals.
+    VariableLocation source;
+    if (scope >= functions[function - 1u].scope_base) {
+        capture(variable);
+        source.kind = VariableLocation::Kind::CELL;
+        source.slot = variable.slot;
+    } else {
+        source.kind = VariableLocation::Kind::UPVALUE;
+        source.slot = resolveUpvalue(function - 1u, scope, variable);
+    }
+
+    upvalues.push_back(&variable);
+    functions[function].declaration->captures.push_back(source);
+    return static_cast<uint32_t>(upvalues.size() - 1u);
+}
+
+void Resolver::capture(Variable& variable) {
+    if (variable.captured) {
+        return;
+    }
+    variable.captured = true;
+    for (auto* use : variable.uses) {
+        use->kind = VariableLocation::Kind::CELL;
     }
 }
 
 void Resolver::resolveFunction(const FnStmt& stmt, FuncType type) {
+    // A loop around the declaration does not make break/continue legal inside the body.
+    const size_t enclosing_loop_nesting_level = loop_nesting_level;
+    loop_nesting_level = 0u;
 
-    func_stack.push(type);
     beginScope();
-
-    for (const auto& param : stmt.params) {
-        declare(param);
-        define(param);
+    functions.push_back({type, &stmt, scopes.size() - 1u, {}, 0u, true, true, {}});
+    stmt.captures.clear();
+    stmt.pure = false;
+    stmt.param_locations.assign(stmt.params.size(), VariableLocation{});
+
+    for (size_t i = 0u; i < stmt.params.size(); ++i) {
+        declare(stmt.params[i], stmt.param_locations[i]);
+        define(stmt.params[i]);
     }
 
     resolve(stmt.body);
     endScope();
-    func_stack.pop();
+    if (functions.back().pure && stmt.captures.empty() && stmt.location.kind == VariableLocation::Kind::GLOBAL) {
+        pure_candidates.emplace_back(&stmt, std::move(functions.back().global_reads));
+    }
+    functions.pop_back();
+    loop_nesting_level = enclosing_loop_nesting_level;
+}
+
+// A function is pure when it only reads its arguments, locals and globals holding pure functions,
+// and has no effect besides its result: no assignments to globals, no printing, no lists, objects
+// or closures. Its global must never be rebound, so calls through it always reach the same code.
+void Resolver::resolvePurity() {
+    std::unordered_map<Symbol, const FnStmt*> pure;
+    for (const auto& [function, reads] : pure_candidates) {
+        if (global_bindings[function->identifier.symbol] == 1u) {
+            pure.emplace(function->identifier.symbol, function);
+        }
+    }
+
+    // Dropping a function can make the functions reading it impure in turn.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const auto& [function, reads] : pure_candidates) {
+            const auto reads_impure = [&](Symbol global) { return !pure.contains(global); };
+            if (pure.contains(function->identifier.symbol) && std::ranges::any_of(reads, reads_impure)) {
+                pure.erase(function->identifier.symbol);
+                changed = true;
+            }
+        }
+    }
+
+    for (const auto& [symbol, function] : pure) {
+        function->pure = true;
+    }
+    pure_candidates.clear();
+}
+
+void Resolver::markImpure() {
+    functions.back().pure = false;
+}
+
+void Resolver::recordGlobalAssignment(const VariableLocation& location, const Token& identifier) {
+    if (location.kind == VariableLocation::Kind::GLOBAL) {
+        ++global_bindings[identifier.symbol];
+        markImpure();
+    }
 }
 
 void Resolver::beginScope() {
@@ -51,24 +162,56 @@ void Resolver::beginScope() {
 }
 
 void Resolver::endScope() {
+    // The scope's variables were the last slots handed out, so they are free again.
+    functions.back().slot_count -= static_cast<uint32_t>(scopes.back().size());
     scopes.pop_back();
 }
 
-void Resolver::declare(const Token& identifier) {
-    if (scopes.empty())
+// Blocks do not get frames of their own: their variables take the next free slots of the frame
+// they run in. Only top-level code has no such frame, so its outermost declaring scope makes one.
+ScopeLayout Resolver::beginBlockScope(bool declares) {
+    beginScope();
+    FunctionScope& function = functions.back();
+    if (!declares) {
+        return ScopeLayout::NONE;
+    }
+    if (function.has_frame) {
+        return ScopeLayout::SLOTS;
+    }
+    function.has_frame = true;
+    return ScopeLayout::FRAME;
+}
+
+void Resolver::endBlockScope(ScopeLayout layout) {
+    endScope();
+    if (layout == ScopeLayout::FRAME) {
+        functions.back().has_frame = false;
+    }
+}
+
+void Resolver::declare(const Token& identifier, VariableLocation& location) {
+    location = VariableLocation{};
+    if (scopes.empty()) {
+        ++global_bindings[identifier.symbol];
         return;
+    }
 
     Scope& scope = scopes.back();
-    if (scope.contains(identifier.lexeme)) {
-        Error::addError(identifier, "Variable with the name '" + identifier.lexeme + "' already exists in this scope");
+    if (scope.contains(identifier.symbol)) {
+        Error::addError(identifier, "Variable with the name '" + std::string{identifier.lexeme()} + "' already exists in this scope");
+        return;
     }
-    scope.try_emplace(identifier.lexeme, false);
+    // Slots are numbered in declaration order, which is also the order the interpreter defines
+    // them in at runtime.
+    location.kind = VariableLocation::Kind::LOCAL;
+    location.slot = functions.back().slot_count++;
+    scope.try_emplace(identifier.symbol, Variable{false, false, location.slot, {&location}});
 }
 
 void Resolver::define(const Token& identifier) {
     if (scopes.empty())
         return;
-    scopes.back()[identifier.lexeme] = true;
+    scopes.back().at(identifier.symbol).defined = true;
 }
 
 std::any Resolver::visit(const BinaryExpr& expr) {
@@ -93,7 +236,8 @@ std::any Resolver::visit(const LiteralExpr& expr) {
 
 std::any Resolver::visit(const AssignExpr& expr) {
     resolve(*expr.value);
-    resolveLocal(&expr, expr.identifier);
+    resolveLocal(expr.location, expr.identifier);
+    recordGlobalAssignment(expr.location, expr.identifier);
     return {};
 }
 
@@ -112,34 +256,43 @@ std::any Resolver::visit(const LogicalExpr& expr) {
 }
 
 std::any Resolver::visit(const SetExpr& expr) {
+    markImpure();
     return {};
 }
 
 std::any Resolver::visit(const GetExpr& expr) {
+    markImpure();
     return {};
 }
 
 std::any Resolver::visit(const SuperExpr& expr) {
+    markImpure();
     return {};
 }
 
 std::any Resolver::visit(const ThisExpr& expr) {
+    markImpure();
     return {};
 }
 
 std::any Resolver::visit(const VarExpr& expr) {
     if (!scopes.empty()) {
         const Scope& scope = scopes.back();
-        if (scope.contains(expr.identifier.lexeme) && !scope.at(expr.identifier.lexeme)) {
+        if (const auto variable = scope.find(expr.identifier.symbol); variable != scope.end() && !variable->second.defined) {
             Error::addError(expr.identifier, "Can't read local variable in its own initializer.");
         }
     }
 
-    resolveLocal(&expr, expr.identifier);
+    resolveLocal(expr.location, expr.identifier);
+    if (expr.location.kind == VariableLocation::Kind::GLOBAL) {
+        functions.back().global_reads.push_back(expr.identifier.symbol);
+    }
     return {};
 }
 
 std::any Resolver::visit(const ListExpr& expr) {
+    // Lists are mutable, so a remembered one could have changed since.
+    markImpure();
     for (const auto& item : expr.items) {
         resolve(*item);
     }
@@ -148,32 +301,36 @@ std::any Resolver::visit(const ListExpr& expr) {
 }
 
 std::any Resolver::visit(const SubscriptExpr& expr) {
+    markImpure();
     resolve(*expr.index);
 
     if (expr.value) {
         resolve(*expr.value);
     }
-    resolveLocal(&expr, expr.identifier);
+    resolveLocal(expr.location, expr.identifier);
     return {};
 }
 
 std::any Resolver::visit(const IncrementExpr& expr) {
-    resolveLocal(&expr, expr.identifier);
+    resolveLocal(expr.location, expr.identifier);
+    recordGlobalAssignment(expr.location, expr.identifier);
     return {};
 }
 
 std::any Resolver::visit(const DecrementExpr& expr) {
-    resolveLocal(&expr, expr.identifier);
+    resolveLocal(expr.location, expr.identifier);
+    recordGlobalAssignment(expr.location, expr.identifier);
     return {};
 }
 
 void Resolver::visit(const BlockStmt& stmt) {
-    beginScope();
+    stmt.layout = beginBlockScope(declaresVariables(stmt.statements));
     resolve(stmt.statements);
-    endScope();
+    endBlockScope(stmt.layout);
 }
 
 void Resolver::visit(const ClassStmt& stmt) {
+    markImpure();
     // WIP 
 }
 
@@ -182,7 +339,9 @@ void Resolver::visit(const ExprStmt& stmt) {
 }
 
 void Resolver::visit(const FnStmt& stmt) {
-    declare(stmt.identifier);
+    // Every call of the enclosing function would create a new closure.
+    markImpure();
+    declare(stmt.identifier, stmt.location);
     define(stmt.identifier);
     resolveFunction(stmt, FuncType::FUNCTION);
 }
@@ -202,13 +361,15 @@ void Resolver::visit(const IfStmt& stmt) {
 }
 
 void Resolver::visit(const PrintStmt& stmt) {
+    markImpure();
     resolve(*stmt.expression);
 }
 
 void Resolver::visit(const ReturnStmt& stmt) {
-    if (func_stack.top() == FuncType::NONE) {
+    if (functions.back().type == FuncType::NONE) {
         Error::addError(stmt.keyword, "Can't return from a top-level code.");
     }
+    stmt.tail_call = functions.back().type == FuncType::FUNCTION && dynamic_cast<const CallExpr*>(stmt.expression.get()) != nullptr;
     if (stmt.expression) {
         resolve(*stmt.expression);
     }
@@ -227,7 +388,7 @@ void Resolver::visit(const ContinueStmt& stmt) {
 }
 
 void Resolver::visit(const VarStmt& stmt) {
-    declare(stmt.identifier);
+    declare(stmt.identifier, stmt.location);
     if (stmt.initializer) {
         resolve(*stmt.initializer);
     }
@@ -244,7 +405,7 @@ void Resolver::visit(const WhileStmt& stmt) {
 
 void Resolver::visit(const ForStmt& stmt) {
     ++loop_nesting_level;
-    beginScope();
+    stmt.layout = beginBlockScope(dynamic_cast<const VarStmt*>(stmt.initializer.get()) != nullptr);
 
     if (stmt.initializer)
         resolve(*stmt.initializer);
@@ -254,6 +415,6 @@ void Resolver::visit(const ForStmt& stmt) {
         resolve(*stmt.increment);
 
     resolve(*stmt.body);
-    endScope();
+    endBlockScope(stmt.layout);
     --loop_nesting_level;
 }
\ No newline at end of file
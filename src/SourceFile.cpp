@@ -0,0 +1,70 @@
+#include "../include/SourceFile.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+SourceFile::SourceFile(const std::string& path) {
+    const bool standard_input = path == "-";
+    const int fd = standard_input ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        const auto size = static_cast<size_t>(info.st_size);
+        if (void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); address != MAP_FAILED) {
+            ::madvise(address, size, MADV_SEQUENTIAL);
+            mapping = address;
+            mapping_size = size;
+        }
+    }
+
+    if (mapping == nullptr) {
+        try {
+            readAll(fd);
+        } catch (...) {
+            if (!standard_input) {
+                ::close(fd);
+            }
+            throw;
+        }
+    }
+
+    if (!standard_input) {
+        ::close(fd);
+    }
+}
+
+SourceFile::~SourceFile() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, mapping_size);
+    }
+}
+
+std::string_view SourceFile::text() const noexcept {
+    if (mapping != nullptr) {
+        return {static_cast<const char*>(mapping), mapping_size};
+    }
+    return buffer;
+}
+
+void SourceFile::readAll(int fd) {
+    char chunk[64 * 1024];
+    while (true) {
+        const ssize_t count = ::read(fd, chunk, sizeof(chunk));
+        if (count == 0) {
+            return;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        buffer.append(chunk, static_cast<size_t>(count));
+    }
+}
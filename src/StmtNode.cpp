@@ -9,7 +9,7 @@ void BlockStmt::accept(StmtVisitor& visitor) const {
     visitor.visit(*this);
 }
 
-ClassStmt::ClassStmt(Token identifier, std::vector<std::unique_ptr<FnStmt>> methods, std::unique_ptr<VarExpr> superclass)
+ClassStmt::ClassStmt(Token identifier, std::vector<unique_node_ptr<FnStmt>> methods, unique_node_ptr<VarExpr> superclass)
     : identifier{std::move(identifier)}, superclass{std::move(superclass)}, methods{ std::move(methods)} {
     assert(this->identifier.type == TokenType::IDENTIFIER);
 }
@@ -0,0 +1,37 @@
+#include "../include/Symbol.hpp"
+#include "../include/Typedef.hpp"
+#include <vector>
+
+namespace Symbols {
+    namespace {
+        struct Table {
+            string_map<Symbol> ids;
+            // Views into the keys of 'ids', which never move.
+            std::vector<std::string_view> names;
+
+            Table() {
+                names.push_back(ids.try_emplace("", none).first->first);
+            }
+        };
+
+        Table& table() {
+            static Table symbols;
+            return symbols;
+        }
+    }
+
+    Symbol intern(std::string_view name) {
+        auto& symbols = table();
+        if (const auto symbol = symbols.ids.find(name); symbol != symbols.ids.end()) {
+            return symbol->second;
+        }
+
+        const auto id = static_cast<Symbol>(symbols.names.size());
+        symbols.names.push_back(symbols.ids.try_emplace(std::string{name}, id).first->first);
+        return id;
+    }
+
+    std::string_view name(Symbol symbol) {
+        return table().names.at(symbol);
+    }
+}
@@ -1,15 +1,55 @@
 #include "../include/Token.hpp"
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-Token::Token(TokenType type, std::string lexeme, unsigned int line) : type{type}, lexeme{std::move(lexeme)}, line{line} {
-}
+namespace Sources {
+    namespace {
+        // Where each text starts, by its first offset, in the order the texts were added.
+        struct Range {
+            uint32_t first;
+            const char* text;
+        };
+
+        std::vector<Range>& ranges() {
+            static std::vector<Range> added;
+            return added;
+        }
+
+        // Offset 0 is left to empty lexemes, which need no text.
+        uint32_t next = 1u;
+    }
+
+    uint32_t add(std::string_view text) {
+        // One more offset for the end of the text, where the _EOF token sits.
+        if (text.size() >= std::numeric_limits<uint32_t>::max() - next) {
+            throw std::length_error("Source texts exceed 4 GB in total.");
+        }
+        const uint32_t first = next;
+        ranges().push_back({first, text.data()});
+        next += static_cast<uint32_t>(text.size()) + 1u;
+        return first;
+    }
 
-Token::Token(Token&& token) noexcept : type{token.type}, lexeme{std::move(token.lexeme)}, line{token.line} {
+    std::string_view slice(uint32_t offset, uint32_t length) {
+        if (length == 0u) {
+            return {};
+        }
+        const auto& added = ranges();
+        const auto range = std::prev(std::upper_bound(added.begin(), added.end(), offset, [](uint32_t value, const Range& range) {
+            return value < range.first;
+        }));
+        return {range->text + (offset - range->first), length};
+    }
 }
 
-Token::Token(const Token& token) : type{token.type}, lexeme{token.lexeme}, line{token.line} {
+Token::Token(TokenType type, uint32_t offset, uint32_t length, unsigned int line, Symbol symbol) noexcept
+    : offset{offset}, length{length}, line{std::min<uint32_t>(line, max_line)}, type{type}, symbol{symbol} {
 }
 
 std::ostream& operator<<(std::ostream& os, const TokenType type) {
@@ -69,6 +109,6 @@ std::ostream& operator<<(std::ostream& os, const TokenType type) {
 }
 
 std::ostream& operator<<(std::ostream& os, const Token& token) {
-    os << token.type << ' ' << token.lexeme;
+    os << token.type << ' ' << token.lexeme();
     return os;
 }
\ No newline at end of file
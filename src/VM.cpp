@@ -0,0 +1,504 @@
+#include "../include/VM.hpp"
+#include "../include/ArrayType.hpp"
+#include "../include/BuiltIn.hpp"
+#include "../include/ListType.hpp"
+#include "../include/Logger.hpp"
+#include <algorithm>
+#include <cmath>
+
+VMClosure::VMClosure(std::shared_ptr<CompiledFunction> function) : function{std::move(function)} {
+    upvalues.reserve(this->function->upvalue_count);
+}
+
+std::string VMClosure::toString() const {
+    return "<fn " + function->name + ">";
+}
+
+VM::VM() : stack(stack_initial), stack_top{stack.data()} {
+    globals.try_emplace(Symbols::intern("clock"), Value{Value::Type::NATIVE, new ClockCallable{}});
+    globals.try_emplace(Symbols::intern("print"), Value{Value::Type::NATIVE, new PrintCallable{}});
+    globals.try_emplace(Symbols::intern("flush"), Value{Value::Type::NATIVE, new FlushCallable{}});
+    globals.try_emplace(Symbols::intern("array"), Value{Value::Type::NATIVE, new ArrayCallable{}});
+    globals.try_emplace(Symbols::intern("sum"), Value{Value::Type::NATIVE, new SumCallable{}});
+    globals.try_emplace(Symbols::intern("min"), Value{Value::Type::NATIVE, new MinCallable{}});
+    globals.try_emplace(Symbols::intern("max"), Value{Value::Type::NATIVE, new MaxCallable{}});
+    globals.try_emplace(Symbols::intern("dot"), Value{Value::Type::NATIVE, new DotCallable{}});
+    globals.try_emplace(Symbols::intern("scale"), Value{Value::Type::NATIVE, new ScaleCallable{}});
+}
+
+void VM::interpret(std::shared_ptr<CompiledFunction> script) {
+    try {
+        Value closure{Value::Type::CLOSURE, new VMClosure(std::move(script))};
+        push(closure);
+        call(&closure.as<VMClosure>(), 0u);
+        run();
+    } catch (const RuntimeError& error) {
+        Error::addRuntimeError(error);
+        resetStack();
+    }
+}
+
+void VM::push(Value value) {
+    *stack_top++ = std::move(value);
+}
+
+Value VM::pop() {
+    return std::move(*--stack_top);
+}
+
+Value& VM::peek(size_t distance) {
+    return stack_top[-1 - static_cast<std::ptrdiff_t>(distance)];
+}
+
+void VM::resetStack() {
+    while (stack_top > stack.data()) {
+        *--stack_top = Value{};
+    }
+    frames.clear();
+    open_upvalues.clear();
+}
+
+// Moves the stack into a larger buffer with at least 'needed' free values and points the frames
+// and open upvalues at the new slots.
+void VM::growStack(size_t needed) {
+    const size_t used = static_cast<size_t>(stack_top - stack.data());
+    std::vector<Value> grown(std::max(stack.size() * 2u, used + needed));
+    std::move(stack.data(), stack_top, grown.data());
+
+    const auto rebase = [&](Value* slot) {
+        return grown.data() + (slot - stack.data());
+    };
+    for (auto& frame : frames) {
+        frame.slots = rebase(frame.slots);
+    }
+    for (const auto& upvalue : open_upvalues) {
+        upvalue->location = rebase(upvalue->location);
+    }
+    stack_top = rebase(stack_top);
+    stack.swap(grown);
+}
+
+// Frames address their locals and temporaries without bounds checks, so a frame starting at
+// 'slots' gets room for everything 'function' keeps on the stack before it runs.
+void VM::reserveFrame(const Value* slots, const CompiledFunction& function) {
+    if (static_cast<size_t>(stack.data() + stack.size() - slots) < function.stack_size) {
+        growStack(function.stack_size);
+    }
+}
+
+unsigned int VM::currentLine() const {
+    if (frames.empty()) {
+        return 0u;
+    }
+    const auto& frame = frames.back();
+    const auto& chunk = frame.closure->function->chunk;
+    const size_t offset = static_cast<size_t>(frame.ip - chunk.code.data());
+    return chunk.lines[offset == 0u ? 0u : offset - 1u];
+}
+
+RuntimeError VM::error(const std::string& message) const {
+    return RuntimeError(Token{TokenType::_EOF, 0u, 0u, currentLine()}, message);
+}
+
+void VM::call(VMClosure* closure, size_t arg_count) {
+    if (arg_count != closure->function->arity) {
+        throw error("Expected " + std::to_string(closure->function->arity) + " arguments but got " + std::to_string(arg_count) + " .");
+    }
+
+    if (frames.size() == frames_max) {
+        throw error("Stack overflow.");
+    }
+    reserveFrame(stack_top - arg_count - 1, *closure->function);
+    frames.push_back({closure, closure->function->chunk.code.data(), stack_top - arg_count - 1});
+}
+
+void VM::callValue(const Value& callee, size_t arg_count) {
+    if (callee.getType() == Value::Type::CLOSURE) {
+        call(&callee.as<VMClosure>(), arg_count);
+        return;
+    }
+
+    if (callee.getType() == Value::Type::NATIVE) {
+        const auto& native = callee.as<NativeCallable>();
+        if (native.getArity() != Callable::variadic && native.getArity() != arg_count) {
+            throw error("Expected " + std::to_string(native.getArity()) + " arguments but got " + std::to_string(arg_count) + " .");
+        }
+        Value result;
+        try {
+            result = native.callNative({stack_top - arg_count, arg_count});
+        } catch (const NativeError& native_error) {
+            throw error(native_error.what());
+        }
+        // Drop the arguments and the callee itself.
+        for (size_t i = 0u; i <= arg_count; ++i) {
+            pop();
+        }
+        push(std::move(result));
+        return;
+    }
+
+    throw error(") is not callable. Callable object must be a function or a class.");
+}
+
+std::shared_ptr<VMUpvalue> VM::captureUpvalue(Value* local) {
+    for (const auto& upvalue : open_upvalues) {
+        if (upvalue->location == local) {
+            return upvalue;
+        }
+    }
+    return open_upvalues.emplace_back(std::make_shared<VMUpvalue>(local));
+}
+
+void VM::closeUpvalues(const Value* last) {
+    std::erase_if(open_upvalues, [last](const std::shared_ptr<VMUpvalue>& upvalue) {
+        if (upvalue->location < last) {
+            return false;
+        }
+        upvalue->closed = *upvalue->location;
+        upvalue->location = &upvalue->closed;
+        return true;
+    });
+}
+
+void VM::run() {
+    CallFrame* frame = &frames.back();
+
+    auto readByte = [&frame]() -> uint8_t {
+        return *frame->ip++;
+    };
+    auto readShort = [&frame]() -> uint16_t {
+        frame->ip += 2;
+        return static_cast<uint16_t>((frame->ip[-2] << 8) | frame->ip[-1]);
+    };
+    auto readConstant = [&]() -> const Value& {
+        return frame->closure->function->chunk.constants[readShort()];
+    };
+    auto readSymbol = [&]() {
+        return static_cast<Symbol>(readConstant().asNumber());
+    };
+    // Leaves the left operand on top of the stack for the result to replace.
+    auto arithmeticOperands = [this]() {
+        if (!peek(0).isNumber() || !peek(1).isNumber()) {
+            throw error("Operands must be numbers.");
+        }
+        return std::pair{peek(1), pop()};
+    };
+    // Replaces both operands with the result of applying 'op' element by element when either is an
+    // array.
+    auto arrayArithmetic = [this](ArrayOperation op) {
+        if ((peek(0).isNumber() && peek(1).isNumber()) || (!peek(0).isArray() && !peek(1).isArray())) {
+            return false;
+        }
+        Value result;
+        try {
+            result = elementwise(op, peek(1), peek(0));
+        } catch (const NativeError& native_error) {
+            throw error(native_error.what());
+        }
+        pop();
+        peek(0) = std::move(result);
+        return true;
+    };
+
+    while (true) {
+        switch (static_cast<OpCode>(readByte())) {
+        case OpCode::CONSTANT:
+            push(readConstant());
+            break;
+        case OpCode::NIL:
+            push({});
+            break;
+        case OpCode::TRUE:
+            push(true);
+            break;
+        case OpCode::FALSE:
+            push(false);
+            break;
+        case OpCode::POP:
+            pop();
+            break;
+        case OpCode::DUP:
+            push(peek(0));
+            break;
+
+        case OpCode::GET_LOCAL:
+            push(frame->slots[readShort()]);
+            break;
+        case OpCode::SET_LOCAL:
+            frame->slots[readShort()] = peek(0);
+            break;
+        case OpCode::GET_GLOBAL: {
+            const Symbol name = readSymbol();
+            const auto global = globals.find(name);
+            if (global == globals.end()) {
+                throw error("Undefined variable '" + std::string{Symbols::name(name)} + "'.");
+            }
+            push(global->second);
+            break;
+        }
+        case OpCode::DEFINE_GLOBAL: {
+            // A script may take over the name of a built-in.
+            const auto [global, inserted] = globals.try_emplace(readSymbol(), peek(0));
+            if (!inserted && global->second.getType() == Value::Type::NATIVE) {
+                global->second = peek(0);
+            }
+            pop();
+            break;
+        }
+        case OpCode::SET_GLOBAL: {
+            const Symbol name = readSymbol();
+            const auto global = globals.find(name);
+            if (global == globals.end()) {
+                throw error("Undefined variable '" + std::string{Symbols::name(name)} + "'.");
+            }
+            global->second = peek(0);
+            break;
+        }
+        case OpCode::GET_UPVALUE:
+            push(*frame->closure->upvalues[readShort()]->location);
+            break;
+        case OpCode::SET_UPVALUE:
+            *frame->closure->upvalues[readShort()]->location = peek(0);
+            break;
+
+        case OpCode::EQUAL: {
+            const bool equal = peek(1) == peek(0);
+            pop();
+            peek(0) = equal;
+            break;
+        }
+        case OpCode::NOT_EQUAL: {
+            const bool equal = peek(1) == peek(0);
+            pop();
+            peek(0) = !equal;
+            break;
+        }
+        case OpCode::GREATER: {
+            const auto [lhs, rhs] = arithmeticOperands();
+            peek(0) = lessNumbers(rhs, lhs);
+            break;
+        }
+        case OpCode::GREATER_EQUAL: {
+            const auto [lhs, rhs] = arithmeticOperands();
+            peek(0) = lessEqualNumbers(rhs, lhs);
+            break;
+        }
+        case OpCode::LESS: {
+            const auto [lhs, rhs] = arithmeticOperands();
+            peek(0) = lessNumbers(lhs, rhs);
+            break;
+        }
+        case OpCode::LESS_EQUAL: {
+            const auto [lhs, rhs] = arithmeticOperands();
+            peek(0) = lessEqualNumbers(lhs, rhs);
+            break;
+        }
+        case OpCode::SUBTRACT: {
+            if (arrayArithmetic(ArrayOperation::SUBTRACT)) {
+                break;
+            }
+            const auto [lhs, rhs] = arithmeticOperands();
+            peek(0) = subtractNumbers(lhs, rhs);
+            break;
+        }
+        case OpCode::MULTIPLY: {
+            if (arrayArithmetic(ArrayOperation::MULTIPLY)) {
+                break;
+            }
+            const auto [lhs, rhs] = arithmeticOperands();
+            peek(0) = multiplyNumbers(lhs, rhs);
+            break;
+        }
+        case OpCode::DIVIDE: {
+            if (arrayArithmetic(ArrayOperation::DIVIDE)) {
+                break;
+            }
+            const auto [lhs, rhs] = arithmeticOperands();
+            if (rhs.asNumber() == 0) {
+                throw error("Division by 0.");
+            }
+            peek(0) = divideNumbers(lhs, rhs);
+            break;
+        }
+        case OpCode::ADD: {
+            const auto& rhs = peek(0);
+            const auto& lhs = peek(1);
+            Value result;
+            if (lhs.isNumber() && rhs.isNumber()) {
+                result = addNumbers(lhs, rhs);
+            } else if (lhs.isString() && rhs.isString()) {
+                result = concatenate(lhs, rhs);
+            } else if (lhs.isNumber() && rhs.isString()) {
+                result = concatenate(Value{lhs.toString()}, rhs);
+            } else if (lhs.isString() && rhs.isNumber()) {
+                result = concatenate(lhs, Value{rhs.toString()});
+            } else if (arrayArithmetic(ArrayOperation::ADD)) {
+                break;
+            } else {
+                throw error("Operands must be of type string or number.");
+            }
+            pop();
+            peek(0) = std::move(result);
+            break;
+        }
+        case OpCode::NOT:
+            peek(0) = !peek(0).isTruthy();
+            break;
+        case OpCode::NEGATE:
+            if (!peek(0).isNumber()) {
+                throw error("Operand must be a number.");
+            }
+            peek(0) = negateNumber(peek(0));
+            break;
+        case OpCode::INCREMENT:
+        case OpCode::DECREMENT: {
+            const bool increment = frame->ip[-1] == static_cast<uint8_t>(OpCode::INCREMENT);
+            const Symbol name = readSymbol();
+            if (!peek(0).isNumber()) {
+                throw error("Cannot " + std::string(increment ? "increment" : "decrement") + " a non integer type '" + std::string{Symbols::name(name)} + "'.");
+            }
+            peek(0) = addNumbers(peek(0), Value{int64_t{increment ? 1 : -1}});
+            break;
+        }
+
+        case OpCode::BUILD_LIST: {
+            const uint8_t count = readByte();
+            Value list{Value::Type::LIST, new List()};
+            for (Value* item = stack_top - count; item != stack_top; ++item) {
+                list.as<List>().append(*item);
+            }
+            for (uint8_t i = 0u; i < count; ++i) {
+                pop();
+            }
+            push(std::move(list));
+            break;
+        }
+        case OpCode::GET_INDEX:
+        case OpCode::SET_INDEX: {
+            const bool assign = frame->ip[-1] == static_cast<uint8_t>(OpCode::SET_INDEX);
+            const Symbol name = readSymbol();
+            const auto& object = peek(assign ? 2 : 1);
+            const auto& index = peek(assign ? 1 : 0);
+
+            if (!object.isList() && !object.isArray()) {
+                throw error("Object '" + std::string{Symbols::name(name)} + "' is not subscriptable.");
+            }
+            int64_t position = 0;
+            if (!indexPosition(index, position)) {
+                throw error("Indices must be integers.");
+            }
+
+            const auto length = static_cast<int64_t>(object.isList() ? object.as<List>().length() : object.as<Array>().length());
+            // Allows negative indexes for reverse order.
+            if (position < 0) {
+                position += length;
+            }
+            if (position < 0 || position >= length) {
+                throw error("Index out of range. Index is " + std::to_string(position) + " but object size is " + std::to_string(length));
+            }
+
+            Value result;
+            if (object.isArray()) {
+                auto& element = object.as<Array>().at(static_cast<size_t>(position));
+                if (assign) {
+                    if (!peek(0).isNumber()) {
+                        throw error("Array elements must be numbers.");
+                    }
+                    element = peek(0).asNumber();
+                    pop();
+                }
+                result = element;
+            } else if (assign) {
+                object.as<List>().at(static_cast<size_t>(position)) = peek(0);
+                result = pop();
+            } else {
+                result = object.as<List>().at(static_cast<size_t>(position));
+            }
+            pop();
+            pop();
+            push(std::move(result));
+            break;
+        }
+
+        case OpCode::JUMP:
+            frame->ip += readShort();
+            break;
+        case OpCode::JUMP_IF_FALSE: {
+            const uint16_t offset = readShort();
+            if (!peek(0).isTruthy()) {
+                frame->ip += offset;
+            }
+            break;
+        }
+        case OpCode::LOOP: {
+            const uint16_t offset = readShort();
+            frame->ip -= offset;
+            break;
+        }
+
+        case OpCode::CALL: {
+            const uint8_t arg_count = readByte();
+            callValue(peek(arg_count), arg_count);
+            frame = &frames.back();
+            break;
+        }
+        case OpCode::TAIL_CALL: {
+            const uint8_t arg_count = readByte();
+            const Value& callee = peek(arg_count);
+            if (callee.getType() != Value::Type::CLOSURE) {
+                // Natives finish right away; the RETURN that follows hands back their result.
+                callValue(callee, arg_count);
+                break;
+            }
+            const auto* function = callee.as<VMClosure>().function.get();
+            if (arg_count != function->arity) {
+                throw error("Expected " + std::to_string(function->arity) + " arguments but got " + std::to_string(arg_count) + " .");
+            }
+
+            // Slide the callee and its arguments over the finished frame and run it in its place,
+            // which may need more room than the finished function did.
+            reserveFrame(frame->slots, *function);
+            closeUpvalues(frame->slots);
+            std::move(stack_top - arg_count - 1, stack_top, frame->slots);
+            while (stack_top > frame->slots + arg_count + 1) {
+                pop();
+            }
+            frame->closure = &frame->slots[0].as<VMClosure>();
+            frame->ip = function->chunk.code.data();
+            break;
+        }
+        case OpCode::CLOSURE: {
+            const auto& function = frame->closure->function->chunk.functions[readShort()];
+            Value closure{Value::Type::CLOSURE, new VMClosure(function)};
+            auto& upvalues = closure.as<VMClosure>().upvalues;
+            for (size_t i = 0u; i < function->upvalue_count; ++i) {
+                const bool is_local = readByte() == 1;
+                const uint16_t index = readShort();
+                upvalues.push_back(is_local ? captureUpvalue(frame->slots + index) : frame->closure->upvalues[index]);
+            }
+            push(std::move(closure));
+            break;
+        }
+        case OpCode::CLOSE_UPVALUE:
+            closeUpvalues(stack_top - 1);
+            pop();
+            break;
+        case OpCode::RETURN: {
+            auto result = pop();
+            closeUpvalues(frame->slots);
+            Value* slots = frame->slots;
+            frames.pop_back();
+
+            while (stack_top > slots) {
+                pop();
+            }
+            if (frames.empty()) {
+                return;
+            }
+            push(std::move(result));
+            frame = &frames.back();
+            break;
+        }
+        }
+    }
+}
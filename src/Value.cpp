@@ -0,0 +1,192 @@
+#include "../include/Value.hpp"
+#include <array>
+#include <charconv>
+
+Value::Value(std::string string) : type{Type::SHORT_STRING}, bits{0u} {
+    if (string.size() <= short_capacity) {
+        short_length = static_cast<uint8_t>(string.size());
+        string.copy(chars, string.size());
+    } else {
+        type = Type::STRING;
+        object = new StringObject{std::move(string)};
+        object->retain();
+    }
+}
+
+bool Value::isTruthy() const noexcept {
+    switch (type) {
+    case Type::NIL:
+        return false;
+    case Type::BOOL:
+        return boolean;
+    default:
+        return true;
+    }
+}
+
+bool Value::operator==(const Value& other) const noexcept {
+    // An integer equals the double of the same value.
+    if (isNumber() && other.isNumber() && type != other.type) {
+        return asNumber() == other.asNumber();
+    }
+    if (type != other.type) {
+        return false;
+    }
+
+    switch (type) {
+    case Type::NIL:
+        return true;
+    case Type::BOOL:
+        return boolean == other.boolean;
+    case Type::INTEGER:
+        return integer == other.integer;
+    case Type::NUMBER:
+        return number == other.number;
+    case Type::SHORT_STRING:
+    case Type::STRING:
+        return asString() == other.asString();
+    default:
+        // Lists, arrays and functions compare by identity.
+        return object == other.object;
+    }
+}
+
+std::string Value::toString() const {
+    switch (type) {
+    case Type::NIL:
+        return "nil";
+    case Type::BOOL:
+        return boolean ? "true" : "false";
+    case Type::INTEGER:
+        return formatNumber(integer);
+    case Type::NUMBER:
+        return formatNumber(number);
+    case Type::SHORT_STRING:
+        return std::string{asString()};
+    default:
+        return object->toString();
+    }
+}
+
+void Value::appendTo(std::string& out) const {
+    switch (type) {
+    case Type::NIL:
+        out += "nil";
+        break;
+    case Type::BOOL:
+        out += boolean ? "true" : "false";
+        break;
+    case Type::INTEGER:
+        appendNumber(out, integer);
+        break;
+    case Type::NUMBER:
+        appendNumber(out, number);
+        break;
+    case Type::SHORT_STRING:
+        out += asString();
+        break;
+    default:
+        object->appendTo(out);
+        break;
+    }
+}
+
+std::string formatNumber(double number) {
+    std::string result;
+    appendNumber(result, number);
+    return result;
+}
+
+std::string formatNumber(int64_t number) {
+    std::string result;
+    appendNumber(result, number);
+    return result;
+}
+
+void appendNumber(std::string& out, double number) {
+    // The shortest digits that read back as the same double, without an exponent.
+    std::array<char, 400> buffer;
+    const auto [end, error] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number, std::chars_format::fixed);
+    out.append(buffer.data(), end);
+}
+
+void appendNumber(std::string& out, int64_t number) {
+    std::array<char, 24> buffer;
+    const auto [end, error] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    out.append(buffer.data(), end);
+}
+
+namespace {
+
+// Below this length concatenating copies the characters, which is cheaper than a rope node.
+constexpr size_t rope_threshold = 64u;
+
+// The StringObject of a long string, or a new one holding a copy of a short string.
+StringObject* ropeLeaf(const Value& string) {
+    if (string.getType() == Value::Type::STRING) {
+        return &string.as<StringObject>();
+    }
+    return new StringObject{std::string{string.asString()}};
+}
+
+} // namespace
+
+StringObject::StringObject(StringObject* left, StringObject* right) : left{left}, right{right}, size{left->length() + right->length()} {
+    left->retain();
+    right->retain();
+}
+
+StringObject::~StringObject() {
+    if (left != nullptr) {
+        releaseAll({left, right});
+    }
+}
+
+// Copies the leaves into one buffer, walking the rope with an explicit stack since a string built
+// by appending in a loop is a rope as deep as the number of appends.
+void StringObject::flatten() const {
+    std::string result;
+    result.reserve(size);
+    std::vector<const StringObject*> pending{right, left};
+    while (!pending.empty()) {
+        const StringObject* node = pending.back();
+        pending.pop_back();
+        if (node->left == nullptr) {
+            result += node->value;
+        } else {
+            pending.push_back(node->right);
+            pending.push_back(node->left);
+        }
+    }
+
+    value = std::move(result);
+    releaseAll({std::exchange(left, nullptr), std::exchange(right, nullptr)});
+}
+
+// Releases rope nodes without recursing through their destructors.
+void StringObject::releaseAll(std::vector<StringObject*> pending) noexcept {
+    while (!pending.empty()) {
+        StringObject* node = pending.back();
+        pending.pop_back();
+        if (node->references() == 1u && node->left != nullptr) {
+            pending.push_back(std::exchange(node->left, nullptr));
+            pending.push_back(std::exchange(node->right, nullptr));
+        }
+        node->release();
+    }
+}
+
+Value concatenate(const Value& lhs, const Value& rhs) {
+    if (rhs.stringLength() == 0u) {
+        return lhs;
+    }
+    if (lhs.stringLength() == 0u) {
+        return rhs;
+    }
+    if (lhs.stringLength() + rhs.stringLength() < rope_threshold) {
+        std::string joined{lhs.asString()};
+        joined += rhs.asString();
+        return joined;
+    }
+    return Value{Value::Type::STRING, new StringObject{ropeLeaf(lhs), ropeLeaf(rhs)}};
+}
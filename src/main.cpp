@@ -1,55 +1,96 @@
+#include "../include/Compiler.hpp"
 #include "../include/Interpreter.hpp"
 #include "../include/Lexer.hpp"
 #include "../include/Logger.hpp"
+#include "../include/Optimizer.hpp"
+#include "../include/Output.hpp"
 #include "../include/Parser.hpp"
 #include "../include/Resolver.hpp"
+#include "../include/SourceFile.hpp"
+#include "../include/VM.hpp"
 
-#include <fstream>
+#include <charconv>
+#include <memory>
+#include <optional>
+#include <system_error>
 
-std::string readFile(std::string_view filename) {
-    std::ifstream file{filename.data(), std::ios::ate};
-    if (!file) {
-        std::cerr << "Failed to open file " << filename.data() << '\n';
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+enum class Engine {
+    TREE,
+    VM
+};
+
+struct Options {
+    Engine engine = Engine::TREE;
+    bool optimize = true;
+    bool jit = true;
+    size_t memo_limit = Interpreter::default_memo_limit;
+    std::optional<Output::FlushPolicy> flush;
+};
+
+std::unique_ptr<SourceFile> readFile(const std::string& filename) {
+    try {
+        return std::make_unique<SourceFile>(filename);
+    } catch (const std::system_error& error) {
+        std::cerr << "Failed to open file " << filename << ": " << error.code().message() << '\n';
         std::exit(74); // I/O error
     }
-    std::string file_contents;
-    file_contents.resize(file.tellg());
-    file.seekg(0, std::ios::beg);
-    file.read(file_contents.data(), file_contents.size());
-    file.close();
-
-    return file_contents;
 }
 
-void run(const std::string& source) {
+void run(std::string_view source, const Options& options) {
     Lexer lexer{source};
-    auto tokens = lexer.scanTokens();
-    Parser parser{std::move(tokens)};
-    const auto statements = parser.parse();
+    Parser parser{lexer};
+    auto program = parser.parse();
+    const auto& statements = program.statements;
 
     if (Error::hadError) {
+        Output::standard().flush();
         Error::report();
         return;
     }
 
-    Interpreter interpreter;
-    Resolver resolver{interpreter};
+    if (options.optimize) {
+        Optimizer optimizer;
+        optimizer.optimize(program.statements);
+    }
+
+    Resolver resolver;
     resolver.resolve(statements);
 
     if (Error::hadError) {
+        Output::standard().flush();
         Error::report();
         return;
     }
 
-    interpreter.interpret(statements);
+    if (options.engine == Engine::VM) {
+        Compiler compiler;
+        auto script = compiler.compile(statements);
+        if (Error::hadError) {
+            Output::standard().flush();
+            Error::report();
+            return;
+        }
+        VM vm;
+        vm.interpret(std::move(script));
+    } else {
+        Interpreter interpreter{options.jit, options.memo_limit};
+        interpreter.interpret(statements);
+    }
+
+    // Whatever the script printed goes out before any error and before the next prompt.
+    Output::standard().flush();
     if (Error::hadRuntimeError) {
         Error::report();
     }
 }
 
-void initFile(const std::string& filename) {
-    std::string file_contents = readFile(filename);
-    run(file_contents);
+void initFile(const std::string& filename, const Options& options) {
+    const auto source = readFile(filename);
+    run(source->text(), options);
     if (Error::hadError) {
         std::exit(65);
     }
@@ -58,7 +99,7 @@ void initFile(const std::string& filename) {
     }
 }
 
-void runPrompt() {
+void runPrompt(const Options& options) {
     while (true) {
         std::cout << "> ";
         std::string line;
@@ -66,7 +107,7 @@ void runPrompt() {
             return;
         }
 
-        run(line);
+        run(line, options);
         if (Error::hadError) {
             std::exit(65);
         }
@@ -79,13 +120,62 @@ void runPrompt() {
 
 
 
+Output::FlushPolicy defaultFlushPolicy() {
+#ifdef __unix__
+    if (isatty(STDOUT_FILENO)) {
+        return Output::FlushPolicy::LINE;
+    }
+#endif
+    return Output::FlushPolicy::SIZE;
+}
+
+void usage() {
+    std::cerr << "Usage: main [--engine=tree|vm] [--no-optimize] [--no-jit] [--memo-limit=N] [--flush=line|size|explicit] [script | -]\n";
+    std::exit(64);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc > 2) {
-        std::exit(64);
-    } else if (argc == 2) {
-        initFile(argv[1]);
+    Options options;
+    std::vector<std::string_view> scripts;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg{argv[i]};
+        if (arg == "--engine=tree") {
+            options.engine = Engine::TREE;
+        } else if (arg == "--engine=vm") {
+            options.engine = Engine::VM;
+        } else if (arg == "--no-optimize") {
+            options.optimize = false;
+        } else if (arg == "--no-jit") {
+            options.jit = false;
+        } else if (arg.starts_with("--memo-limit=")) {
+            const auto value = arg.substr(std::string_view{"--memo-limit="}.size());
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), options.memo_limit);
+            if (error != std::errc{} || end != value.data() + value.size()) {
+                usage();
+            }
+        } else if (arg == "--flush=line") {
+            options.flush = Output::FlushPolicy::LINE;
+        } else if (arg == "--flush=size") {
+            options.flush = Output::FlushPolicy::SIZE;
+        } else if (arg == "--flush=explicit") {
+            options.flush = Output::FlushPolicy::EXPLICIT;
+        } else if (arg.starts_with("--")) {
+            usage();
+        } else {
+            scripts.push_back(arg);
+        }
+    }
+
+    // Like C stdio: lines show up as they are printed on a terminal, anything else gets blocks.
+    Output::standard().setPolicy(options.flush.value_or(defaultFlushPolicy()));
+
+    if (scripts.size() > 1) {
+        usage();
+    } else if (scripts.size() == 1) {
+        initFile(std::string(scripts.front()), options);
     } else {
-        runPrompt();
+        runPrompt(options);
     }
     return 0;
 }
@@ -0,0 +1,107 @@
+#include "../include/ArrayType.hpp"
+#include "ScriptRunner.hpp"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Values whose sum depends on the order they are added in.
+std::vector<double> awkward(size_t count) {
+    std::vector<double> values(count);
+    for (size_t i = 0u; i < count; ++i) {
+        values[i] = (i % 3u == 0u) ? 1e16 : (i % 3u == 1u) ? 1.25 + static_cast<double>(i) : -1e16;
+    }
+    return values;
+}
+
+// The order the kernels promise: sixteen running partials, combined from left to right.
+template <typename Op>
+double reference(const std::vector<double>& values, double initial, Op op) {
+    std::vector<double> partials(16u, initial);
+    for (size_t i = 0u; i < values.size(); ++i) {
+        partials[i % 16u] = op(values[i], partials[i % 16u]);
+    }
+    double result = partials[0];
+    for (size_t i = 1u; i < partials.size(); ++i) {
+        result = op(partials[i], result);
+    }
+    return result;
+}
+
+double add(double lhs, double rhs) { return lhs + rhs; }
+double less(double lhs, double rhs) { return lhs < rhs ? lhs : rhs; }
+double greater(double lhs, double rhs) { return lhs > rhs ? lhs : rhs; }
+
+void expectOnBothEngines(const std::string& source, const std::string& expected) {
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
+
+} // namespace
+
+// Lengths on both sides of the sixteen-lane blocks, so both the vector loop and the tail run.
+TEST(ArrayTest, KernelsAddUpInAFixedOrder) {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    for (size_t count = 0u; count <= 40u; ++count) {
+        auto values = awkward(count);
+        EXPECT_EQ(kernels::sum(values), reference(values, 0.0, add)) << count;
+
+        std::vector<double> products(count);
+        const auto others = awkward(count + 1u);
+        for (size_t i = 0u; i < count; ++i) {
+            products[i] = values[i] * others[i + 1u];
+        }
+        EXPECT_EQ(kernels::dot(values, std::span{others}.subspan(1u)), reference(products, 0.0, add)) << count;
+
+        if (count > 0u) {
+            values[count / 2u] = std::nan("");
+            EXPECT_EQ(kernels::min(values), reference(values, inf, less)) << count;
+            EXPECT_EQ(kernels::max(values), reference(values, -inf, greater)) << count;
+            EXPECT_FALSE(std::isnan(kernels::min(values)) || std::isnan(kernels::max(values))) << count;
+        }
+
+        const auto scaled = kernels::scale(others, -0.5);
+        for (size_t i = 0u; i < others.size(); ++i) {
+            EXPECT_EQ(scaled[i], others[i] * -0.5) << count;
+        }
+    }
+}
+
+TEST(ArrayTest, ElementwiseMatchesScalarArithmetic) {
+    for (size_t count = 0u; count <= 9u; ++count) {
+        const auto values = awkward(count);
+        const Value array{Value::Type::ARRAY, new Array{values}};
+        const Value divided = elementwise(ArrayOperation::DIVIDE, Value{3.0}, array);
+        const Value product = elementwise(ArrayOperation::MULTIPLY, array, array);
+        const Value difference = elementwise(ArrayOperation::SUBTRACT, array, Value{0.5});
+        for (size_t i = 0u; i < count; ++i) {
+            EXPECT_EQ(divided.as<Array>().elements()[i], 3.0 / values[i]);
+            EXPECT_EQ(product.as<Array>().elements()[i], values[i] * values[i]);
+            EXPECT_EQ(difference.as<Array>().elements()[i], values[i] - 0.5);
+        }
+    }
+}
+
+TEST(ArrayTest, ScriptsUseArraysTheSameOnBothEngines) {
+    expectOnBothEngines(R"(
+atom xs = array([1, 2, 3, 4]);
+atom ys = array(4);
+ys[0] = 10;
+print(xs * 2 + ys, 1 / xs, xs - 1.5, xs / 0);
+print(sum(xs), min(xs), max(xs), dot(xs, xs), scale(xs, 0.5));
+print(array(0), sum(array(0)), array(xs) == xs);
+)", "[ 12, 4, 6, 8 ] [ 1, 0.5, 0.3333333333333333, 0.25 ] [ -0.5, 0.5, 1.5, 2.5 ] [ inf, inf, inf, inf ] \n"
+    "10 1 4 30 [ 0.5, 1, 1.5, 2 ] \n[ ] 0 false \n");
+}
+
+TEST(ArrayTest, MisuseIsReported) {
+    expectOnBothEngines("print(min(array(0)));", "error: min() of an empty array.\n");
+    expectOnBothEngines("print(array([1, 2]) + array([1]));", "error: Arrays must have the same length, but got 2 and 1.\n");
+    expectOnBothEngines("print(array([1, \"a\"]));", "error: Array elements must be numbers.\n");
+    expectOnBothEngines("atom xs = array(2);\nprint(xs[2]);", "error: Index out of range. Index is 2 but object size is 2\n");
+}
+
+// A script's own definition replaces a built-in of the same name.
+TEST(ArrayTest, ScriptsMayRedefineBuiltins) {
+    expectOnBothEngines("mission sum(a, b) { transmit (a + b); }\nprint(sum(2, 3));", "5 \n");
+}
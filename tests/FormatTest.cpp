@@ -0,0 +1,31 @@
+#include "ScriptRunner.hpp"
+#include <cstdlib>
+#include <limits>
+
+// Numbers print as the shortest digits that read back as the same number, without an exponent.
+TEST(FormatTest, ShortestRoundTripDigits) {
+    EXPECT_EQ(formatNumber(0.1 + 0.2), "0.30000000000000004");
+    EXPECT_EQ(formatNumber(1e21), "1000000000000000000000");
+    EXPECT_EQ(formatNumber(1e-7), "0.0000001");
+    EXPECT_EQ(formatNumber(-0.0), "-0");
+    EXPECT_EQ(formatNumber(3.0), "3");
+    EXPECT_EQ(formatNumber(int64_t{-42}), "-42");
+    EXPECT_EQ(formatNumber(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+
+    for (const double number : {0.1, 1.0 / 3.0, 123456789.125, 5e-324, 1.7976931348623157e308}) {
+        EXPECT_EQ(std::strtod(formatNumber(number).c_str(), nullptr), number);
+    }
+}
+
+// Printing and string concatenation use the same digits on both engines.
+TEST(FormatTest, PrintedNumbers) {
+    const std::string source = R"(
+print(0.1 + 0.2, 1000000000000000000000, -0, 3.0, 2.5 * 2, 7 / 2);
+print("n" + 0.5, "n" + 4.0, 1 / 3 + "");
+)";
+    const std::string expected = "0.30000000000000004 1000000000000000000000 -0 3 5 3.5 \n"
+                                 "n0.5 n4 0.3333333333333333 \n";
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+    EXPECT_EQ(runScript(source, {.optimize = false}), expected);
+}
@@ -0,0 +1,41 @@
+#include "ScriptRunner.hpp"
+
+TEST(IntegerTest, LargeIntegersCompareExactly) {
+    // The first evaluation takes the generic path; later ones run the quickened node.
+    const auto source = R"(
+atom a = 9007199254740993;
+atom b = 9007199254740992;
+navigate (atom i = 0; i < 3; i++) {
+    print(a == b, a != b, a == 9007199254740993.0);
+}
+)";
+    const std::string expected = "false true true \nfalse true true \nfalse true true \n";
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
+
+TEST(IntegerTest, OverflowFallsBackToDoubles) {
+    const auto source = R"(
+atom big = 9223372036854775807;
+print(big, big + 1, 6 / 4, 6 / 3, -0 * 1);
+)";
+    const auto expected = runScript(source);
+    EXPECT_EQ(expected, "9223372036854775807 9223372036854775808 1.5 2 -0 \n");
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
+
+TEST(IntegerTest, LargeIntegersOrderExactly) {
+    // Quickened, generic and folded comparisons; a double operand makes both compare as doubles.
+    const auto source = R"(
+atom a = 9007199254740993;
+atom b = 9007199254740992;
+navigate (atom i = 0; i < 3; i++) {
+    print(a > b, a >= b, b < a, a <= b, a > 9007199254740992.0);
+}
+print(9007199254740993 > 9007199254740992, 9007199254740992 >= 9007199254740993);
+)";
+    const std::string expected = "true true true false false \ntrue true true false false \ntrue true true false false \ntrue false \n";
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.optimize = false}), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
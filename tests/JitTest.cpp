@@ -0,0 +1,150 @@
+#include "ScriptRunner.hpp"
+
+namespace {
+
+// Calls each mission often enough to compile it and prints the results of every call.
+std::string hotLoop(const std::string& missions, const std::string& calls) {
+    return missions + "\nnavigate (atom i = 0; i < 100; i++) {\n    print(" + calls + ");\n}\n";
+}
+
+// Compares the compiled run with an interpreted one. Memoization is off so every call reaches
+// the compiled code.
+void expectSameAsInterpreter(const std::string& source) {
+    const auto compiled = runScript(source, {.memo_limit = 0u});
+    const auto interpreted = runScript(source, {.jit = false, .memo_limit = 0u});
+    EXPECT_EQ(compiled.find("error:"), std::string::npos) << compiled;
+    EXPECT_EQ(compiled, interpreted);
+    EXPECT_EQ(compiled, runScript(source, {.vm = true}));
+}
+
+} // namespace
+
+TEST(JitTest, IntegerResultsStayIntegers) {
+    const auto source = hotLoop("mission inc(n) { transmit (n + 1); }", "inc(2) * 3000000000000000001");
+    const auto output = runScript(source, {.memo_limit = 0u});
+    EXPECT_EQ(output.substr(0, output.find('\n')), "9000000000000000003 ");
+    expectSameAsInterpreter(source);
+}
+
+TEST(JitTest, DoublesMatchTheInterpreter) {
+    expectSameAsInterpreter(hotLoop(R"(
+mission half(n) { transmit (n / 2); }
+mission negate(n) { transmit (-n); }
+mission zero(n) { transmit (n * -1 + 1); }
+mission scaled(n) { transmit (n * 1.5); }
+)", "half(i) * 3000000000000000001, negate(i - 50), zero(0) * 3000000000000000001, scaled(i), half(i + 0.5)"));
+}
+
+TEST(JitTest, RecursionMatchesTheInterpreter) {
+    expectSameAsInterpreter(hotLoop(R"(
+mission fib(n) {
+    probe (n < 2) transmit (n);
+    transmit (fib(n - 2) + fib(n - 1));
+}
+mission count(n, acc) {
+    probe (n == 0) transmit (acc);
+    transmit (count(n - 1, acc + n));
+}
+)", "fib(10), count(i * 20, 0), fib(12) - fib(11)"));
+}
+
+TEST(JitTest, LoopsAndConditionsMatchTheInterpreter) {
+    expectSameAsInterpreter(hotLoop(R"(
+mission collatz(n) {
+    atom steps = 0;
+    orbit (n != 1) {
+        probe (n / 2 * 2 == n) {
+            n = n / 2;
+        } blackhole {
+            n = 3 * n + 1;
+        }
+        steps++;
+    }
+    transmit (steps);
+}
+mission clamp(n, low, high) {
+    probe (n < low or n > high and !(high < low)) {
+        probe (n < low) transmit (low);
+        transmit (high);
+    }
+    transmit (n);
+}
+mission skips(n) {
+    atom total = 0;
+    navigate (atom k = 0; k < n; k++) {
+        probe (k == 7) warp;
+        probe (k > 40) eject;
+        total = total + k;
+    }
+    transmit (total);
+}
+)", "collatz(i + 1), clamp(i, 10, 90), skips(i)"));
+}
+
+// Compiled calls check that the global still holds the mission before calling it again, and
+// leave a call that fails at runtime to the interpreter to report.
+TEST(JitTest, GuardsHandBackToTheInterpreter) {
+    const auto source = hotLoop(R"(
+mission down(n) {
+    probe (n == 0) transmit (0);
+    transmit (1 + down(n - 1));
+}
+mission ratio(a, b) { transmit (a / b); }
+)", "down(i), ratio(i, 1)");
+    const std::string divide = source + "print(ratio(1, 0));\n";
+    const std::string rebind = source + "atom old = down;\ndown = ratio;\nprint(old(0));\nprint(old(5));\n";
+
+    const auto divided = runScript(divide, {.memo_limit = 0u});
+    EXPECT_TRUE(divided.ends_with("99 99 \nerror: Division by 0.\n")) << divided;
+    EXPECT_EQ(divided, runScript(divide, {.jit = false, .memo_limit = 0u}));
+
+    const auto rebound = runScript(rebind, {.memo_limit = 0u});
+    EXPECT_TRUE(rebound.ends_with("99 99 \n0 \nerror: Expected 2 arguments but got 1 .\n")) << rebound;
+    EXPECT_EQ(rebound, runScript(rebind, {.jit = false, .memo_limit = 0u}));
+}
+
+// Compiled code belongs to the interpreter that compiled it, so a resolved program can be run
+// again by another one after the first is gone.
+TEST(JitTest, ProgramsOutliveTheirInterpreters) {
+    const std::string source = hotLoop("mission inc(n) { transmit (n + 1); }", "inc(1)");
+    Lexer lexer{source};
+    Parser parser{lexer};
+    auto program = parser.parse();
+    Resolver resolver;
+    resolver.resolve(program.statements);
+    const auto& mission = static_cast<const FnStmt&>(*program.statements.front());
+
+    for (int run = 0; run < 2; ++run) {
+        testing::internal::CaptureStdout();
+        Interpreter interpreter{true, 0u};
+        interpreter.interpret(program.statements);
+        Output::standard().flush();
+        const auto output = testing::internal::GetCapturedStdout();
+        EXPECT_EQ(output.substr(0, output.find('\n')), "2 ") << run;
+#if defined(__x86_64__) && defined(__linux__)
+        EXPECT_TRUE(interpreter.isCompiled(mission)) << run;
+#endif
+    }
+}
+
+// A counter stepped past 2^53 in compiled code hands the call back to the interpreter, which
+// keeps counting exactly.
+TEST(JitTest, SteppingPast2To53Bails) {
+    const auto source = hotLoop(R"(
+mission up(n) {
+    atom k = n;
+    k++;
+    ++k;
+    transmit (k - n);
+}
+mission down(n) {
+    atom k = n;
+    k--;
+    --k;
+    transmit (n - k);
+}
+)", "up(i), down(-i)") + "print(up(9007199254740991), down(-9007199254740991));\n";
+    const auto output = runScript(source, {.memo_limit = 0u});
+    EXPECT_TRUE(output.ends_with("2 2 \n2 2 \n")) << output;
+    EXPECT_EQ(output, runScript(source, {.jit = false, .memo_limit = 0u}));
+}
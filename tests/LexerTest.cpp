@@ -0,0 +1,30 @@
+#include "ScriptRunner.hpp"
+
+// String literals may be longer than 16 MB; the token keeps the whole lexeme.
+TEST(LexerTest, LongStringLiterals) {
+    const size_t length = (size_t{1} << 24) + 10u;
+    const std::string source = "atom s = \"" + std::string(length, 'x') + "\"; print(\"done\");";
+
+    Lexer lexer{source};
+    const auto tokens = lexer.scanTokens();
+    ASSERT_EQ(tokens.size(), 11u);
+    EXPECT_EQ(tokens[3].type, TokenType::STRING);
+    EXPECT_EQ(tokens[3].lexeme().size(), length);
+    EXPECT_EQ(tokens[3].lexeme().back(), 'x');
+    EXPECT_EQ(tokens[5].lexeme(), "print");
+
+    EXPECT_EQ(runScript(source), "done \n");
+}
+
+// Tokens keep their line up to Token::max_line and report later ones as that line.
+TEST(LexerTest, LinesSaturate) {
+    const std::string source = "a\nb" + std::string(Token::max_line, '\n') + "c";
+
+    Lexer lexer{source};
+    const auto tokens = lexer.scanTokens();
+    ASSERT_EQ(tokens.size(), 4u);
+    EXPECT_EQ(tokens[0].line, 1u);
+    EXPECT_EQ(tokens[1].line, 2u);
+    EXPECT_EQ(tokens[2].line, Token::max_line);
+    EXPECT_EQ(tokens[2].lexeme(), "c");
+}
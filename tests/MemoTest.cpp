@@ -0,0 +1,107 @@
+#include "ScriptRunner.hpp"
+
+namespace {
+
+// Runs 'source' on the tree-walker with default flags and reports whether the first statement,
+// a mission, ended up compiled to machine code.
+bool compiledWithDefaults(std::string_view source, std::string& output) {
+    testing::internal::CaptureStdout();
+    Lexer lexer{source};
+    Parser parser{lexer};
+    auto program = parser.parse();
+    Optimizer optimizer;
+    optimizer.optimize(program.statements);
+    Resolver resolver;
+    resolver.resolve(program.statements);
+    Interpreter interpreter;
+    interpreter.interpret(program.statements);
+    Output::standard().flush();
+    output = testing::internal::GetCapturedStdout();
+
+    const auto& mission = static_cast<const FnStmt&>(*program.statements.front());
+    EXPECT_TRUE(mission.pure);
+    return interpreter.isCompiled(mission);
+}
+
+} // namespace
+
+// A memoized mission keeps its memo once it is compiled: misses run the machine code and their
+// results are remembered.
+TEST(MemoTest, CompiledMissionsKeepTheirMemo) {
+    const std::string source = R"(
+mission triangle(n) {
+    atom total = 0;
+    navigate (atom i = 1; i <= n; i++) {
+        total = total + i;
+    }
+    transmit (total);
+}
+navigate (atom round = 0; round < 3; round++) {
+    navigate (atom i = 0; i < 100; i++) {
+        print(triangle(i));
+    }
+}
+)";
+    std::string output;
+    const bool compiled = compiledWithDefaults(source, output);
+#if defined(__x86_64__) && defined(__linux__)
+    EXPECT_TRUE(compiled);
+#endif
+    EXPECT_EQ(output.substr(0, 16), "0 \n1 \n3 \n6 \n10 \n");
+    EXPECT_EQ(output, runScript(source, {.jit = false, .memo_limit = 0u}));
+}
+
+// Recursive calls go through the memo rather than the machine code, so the memo still turns an
+// exponential recursion into a linear one.
+TEST(MemoTest, RecursionUsesTheMemo) {
+    const std::string source = R"(
+mission fib(n) {
+    probe (n < 2) transmit (n);
+    transmit (fib(n - 2) + fib(n - 1));
+}
+print(fib(90));
+)";
+    std::string output;
+    compiledWithDefaults(source, output);
+    EXPECT_EQ(output, "2880067194370816120 \n");
+}
+
+// Integer and double arguments are different memo keys, and missions that print or read a
+// global that changes are not memoized.
+TEST(MemoTest, OnlySameArgumentsOfPureMissionsShareResults) {
+    const std::string source = R"(
+mission big(n) { transmit (n * 3000000000000000001); }
+mission shout(n) {
+    print("called", n);
+    transmit (n);
+}
+atom offset = 1;
+mission shifted(n) { transmit (n + offset); }
+navigate (atom i = 0; i < 2; i++) {
+    print(big(3), big(3.0), shout(i), shifted(i));
+    offset = 10;
+}
+print(shout(1), shifted(0));
+)";
+    const std::string expected = "called 0 \n9000000000000000003 9000000000000000000 0 1 \n"
+                                 "called 1 \n9000000000000000003 9000000000000000000 1 11 \n"
+                                 "called 1 \n1 10 \n";
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.memo_limit = 0u}), expected);
+}
+
+// A full memo stops remembering but keeps answering from what it has.
+TEST(MemoTest, FullMemoKeepsWorking) {
+    const std::string source = R"(
+mission square(n) { transmit (n * n); }
+navigate (atom round = 0; round < 2; round++) {
+    atom total = 0;
+    navigate (atom i = 0; i < 50; i++) {
+        total = total + square(i);
+    }
+    print(total);
+}
+)";
+    EXPECT_EQ(runScript(source, {.memo_limit = 10u}), "40425 \n40425 \n");
+    EXPECT_EQ(runScript(source, {.memo_limit = 0u}), "40425 \n40425 \n");
+}
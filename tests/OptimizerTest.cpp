@@ -0,0 +1,119 @@
+#include "ScriptRunner.hpp"
+
+namespace {
+
+// Parses and optimizes 'source', which has to outlive the program.
+Program optimize(std::string_view source) {
+    Lexer lexer{source};
+    Parser parser{lexer};
+    auto program = parser.parse();
+    Optimizer optimizer;
+    optimizer.optimize(program.statements);
+    return program;
+}
+
+// The initializer of the variable declared by statement 'index'.
+const Expr& initializer(const Program& program, size_t index) {
+    return *static_cast<const VarStmt&>(*program.statements[index]).initializer;
+}
+
+std::string folded(const Program& program, size_t index) {
+    const auto* literal = dynamic_cast<const LiteralExpr*>(&initializer(program, index));
+    return literal != nullptr ? literal->literal.toString() : "not folded";
+}
+
+void expectSameWithoutOptimizer(const std::string& source, const std::string& expected) {
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.optimize = false}), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
+
+} // namespace
+
+TEST(OptimizerTest, FoldsOperationsOnLiterals) {
+    const std::string source = R"(
+atom a = 1 + 2 * (3 - 10);
+atom b = 7 / 2;
+atom c = "n" + 1.5 + "!";
+atom d = !(1 < 2) == (3 > 4);
+atom e = -(-4.25);
+)";
+    const auto program = optimize(source);
+    EXPECT_EQ(folded(program, 0), "-13");
+    EXPECT_EQ(folded(program, 1), "3.5");
+    EXPECT_EQ(folded(program, 2), "n1.5!");
+    EXPECT_EQ(folded(program, 3), "true");
+    EXPECT_EQ(folded(program, 4), "4.25");
+}
+
+// Operations that fail at runtime stay in the program, and so do identities that could change
+// the value: x + 0 turns -0 into 0, and x * 1 is an error or a repetition for non-numbers.
+TEST(OptimizerTest, KeepsWhatCouldFailOrChange) {
+    const std::string source = R"(
+atom a = 1 / 0;
+atom b = "a" - 1;
+atom c = a + 0;
+atom d = a * 1;
+atom e = -a - 0;
+)";
+    const auto program = optimize(source);
+    EXPECT_EQ(folded(program, 0), "not folded");
+    EXPECT_EQ(folded(program, 1), "not folded");
+    EXPECT_NE(dynamic_cast<const BinaryExpr*>(&initializer(program, 2)), nullptr);
+    EXPECT_NE(dynamic_cast<const BinaryExpr*>(&initializer(program, 3)), nullptr);
+    EXPECT_NE(dynamic_cast<const UnaryExpr*>(&initializer(program, 4)), nullptr);
+
+    expectSameWithoutOptimizer("atom z = -0.0;\nprint(z + 0, z * 1, -(-z));\nprint(1 / 0);\n", "0 -0 -0 \nerror: Division by 0.\n");
+    expectSameWithoutOptimizer("atom s = \"a\";\nprint(s - 0);\n", "error: Operands must be numbers.\n");
+}
+
+TEST(OptimizerTest, MarksCountedLoops) {
+    const std::string source = R"(
+navigate (atom i = 0; i < 10; i++) print(i);
+navigate (atom i = 10; i >= 0; --i) print(i);
+navigate (atom i = 0; i < 10; i++) i = i + 1;
+navigate (atom i = 0; 10 > i; i++) print(i);
+navigate (atom i = 0; i < 10; i = i + 1) print(i);
+)";
+    const auto program = optimize(source);
+    const auto counted = [&](size_t index) {
+        return static_cast<const ForStmt&>(*program.statements[index]).counted;
+    };
+    ASSERT_TRUE(counted(0).has_value());
+    EXPECT_EQ(counted(0)->step, 1);
+    ASSERT_TRUE(counted(1).has_value());
+    EXPECT_EQ(counted(1)->step, -1);
+    EXPECT_FALSE(counted(2).has_value());
+    EXPECT_FALSE(counted(3).has_value());
+    EXPECT_FALSE(counted(4).has_value());
+}
+
+// Counted loops still evaluate the limit on every iteration, count integers exactly past 2^53 as
+// the increment would, and leave a counter that is not a number to the ordinary loop.
+TEST(OptimizerTest, CountedLoopsRunLikeOrdinaryOnes) {
+    expectSameWithoutOptimizer(R"(
+atom n = 5;
+navigate (atom i = 0; i < n; i++) {
+    probe (i == 1) n = 3;
+    print(i);
+}
+navigate (atom i = 0.5; i <= 2; i++) print(i);
+navigate (atom i = 3; i > 0; --i) {
+    probe (i == 2) warp;
+    print(i);
+}
+navigate (atom i = 9007199254740990; i < 9007199254740994; i++) print(i);
+navigate (atom i = 0; i < 10; i++) {
+    probe (i > 1) eject;
+    print(i);
+}
+atom getters = [nil, nil];
+navigate (atom i = 0; i < 2; i++) {
+    mission get() { transmit (i); }
+    getters[i] = get;
+}
+print(getters[0](), getters[1]());
+navigate (atom i = "a"; i < 3; i++) print(i);
+)", "0 \n1 \n2 \n0.5 \n1.5 \n3 \n1 \n9007199254740990 \n9007199254740991 \n9007199254740992 \n9007199254740993 \n"
+    "0 \n1 \n2 2 \nerror: Operands must be numbers.\n");
+}
@@ -0,0 +1,92 @@
+#include "ScriptRunner.hpp"
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+// Sets the policy of standard output for one test and puts the default back afterwards.
+class OutputTest : public testing::Test {
+protected:
+    Output& output = Output::standard();
+
+    void TearDown() override {
+        output.flush();
+        output.setPolicy(Output::FlushPolicy::SIZE);
+    }
+
+    // Appends 'text' as one line and returns what reached standard output by then.
+    std::string writeLine(const std::string& text) {
+        testing::internal::CaptureStdout();
+        output.append(Value{text});
+        output.endLine();
+        return testing::internal::GetCapturedStdout();
+    }
+};
+
+} // namespace
+
+TEST_F(OutputTest, LinePolicyWritesEveryLine) {
+    output.setPolicy(Output::FlushPolicy::LINE);
+    EXPECT_EQ(writeLine("first"), "first\n");
+    EXPECT_EQ(writeLine("second"), "second\n");
+}
+
+// Lines wait until Output::capacity bytes are buffered and then go out together.
+TEST_F(OutputTest, SizePolicyWritesFullBuffers) {
+    output.setPolicy(Output::FlushPolicy::SIZE);
+    EXPECT_EQ(writeLine("waiting"), "");
+
+    const std::string line(Output::capacity, 'x');
+    EXPECT_EQ(writeLine(line), "waiting\n" + line + "\n");
+    EXPECT_EQ(writeLine("next"), "");
+}
+
+// Nothing is written, however much is buffered, until flush() is called.
+TEST_F(OutputTest, ExplicitPolicyWaitsForFlush) {
+    output.setPolicy(Output::FlushPolicy::EXPLICIT);
+    const std::string line(Output::capacity, 'x');
+    EXPECT_EQ(writeLine("waiting"), "");
+    EXPECT_EQ(writeLine(line), "");
+
+    testing::internal::CaptureStdout();
+    output.flush();
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "waiting\n" + line + "\n");
+}
+
+// The flush() builtin writes out what a script printed so far on both engines.
+TEST_F(OutputTest, FlushBuiltinWritesPendingOutput) {
+    output.setPolicy(Output::FlushPolicy::EXPLICIT);
+    for (const bool vm : {false, true}) {
+        testing::internal::CaptureStdout();
+        Lexer lexer{R"(print("before"); flush(); print("after");)"};
+        Parser parser{lexer};
+        auto program = parser.parse();
+        Resolver resolver;
+        resolver.resolve(program.statements);
+        if (vm) {
+            Compiler compiler;
+            VM{}.interpret(compiler.compile(program.statements));
+        } else {
+            Interpreter{}.interpret(program.statements);
+        }
+        EXPECT_EQ(testing::internal::GetCapturedStdout(), "before \n");
+
+        testing::internal::CaptureStdout();
+        output.flush();
+        EXPECT_EQ(testing::internal::GetCapturedStdout(), "after \n");
+    }
+}
+
+// Output still buffered when the program exits is written out. The child sends standard output
+// to standard error, where the death test can see it.
+TEST_F(OutputTest, ExitWritesPendingOutput) {
+    output.setPolicy(Output::FlushPolicy::EXPLICIT);
+    EXPECT_EXIT(
+        {
+            std::cout.rdbuf(std::cerr.rdbuf());
+            output.append(Value{"pending at exit"});
+            output.endLine();
+            std::exit(0);
+        },
+        testing::ExitedWithCode(0), "pending at exit");
+}
@@ -0,0 +1,60 @@
+#include "ScriptRunner.hpp"
+
+namespace {
+
+void expectOnEveryEngine(const std::string& source, const std::string& expected) {
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.optimize = false}), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
+
+} // namespace
+
+// Blocks share the frame of their function, but their variables still shadow and go out of scope
+// where the block ends.
+TEST(ScopeTest, FlattenedBlocksKeepTheirScopes) {
+    expectOnEveryEngine(R"(
+atom x = "global";
+{
+    atom x = "outer";
+    {
+        atom x = "inner";
+        print(x);
+    }
+    print(x);
+    {
+        print(x);
+    }
+}
+print(x);
+mission nest(n) {
+    atom total = 0;
+    navigate (atom i = 0; i < n; i++) {
+        {
+            atom doubled = i * 2;
+            probe (doubled > 4) {
+                atom extra = doubled + 1;
+                total = total + extra;
+            } blackhole {
+                total = total + doubled;
+            }
+        }
+    }
+    transmit (total);
+}
+print(nest(5));
+)", "inner \nouter \nouter \nglobal \n22 \n");
+}
+
+// A variable declared in a loop body is a new variable on every iteration, even in a shared frame.
+TEST(ScopeTest, ClosuresCaptureEachIteration) {
+    expectOnEveryEngine(R"(
+atom getters = [nil, nil, nil];
+navigate (atom i = 0; i < 3; i++) {
+    atom copy = i * 10;
+    mission get() { transmit (copy); }
+    getters[i] = get;
+}
+print(getters[0](), getters[1](), getters[2]());
+)", "0 10 20 \n");
+}
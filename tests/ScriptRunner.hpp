@@ -0,0 +1,70 @@
+#ifndef SCRIPT_RUNNER_HPP
+#define SCRIPT_RUNNER_HPP
+
+#include "../include/Compiler.hpp"
+#include "../include/Interpreter.hpp"
+#include "../include/Lexer.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Optimizer.hpp"
+#include "../include/Output.hpp"
+#include "../include/Parser.hpp"
+#include "../include/Resolver.hpp"
+#include "../include/VM.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+
+struct RunOptions {
+    bool vm = false;
+    bool optimize = true;
+    bool jit = true;
+    size_t memo_limit = Interpreter::default_memo_limit;
+};
+
+// Runs 'source' through the same stages as main and returns what it printed, followed by one
+// "error: <message>" line per reported error.
+inline std::string runScript(std::string_view source, const RunOptions& options = {}) {
+    testing::internal::CaptureStdout();
+    [&] {
+        Lexer lexer{source};
+        Parser parser{lexer};
+        auto program = parser.parse();
+        if (Error::hadError) {
+            return;
+        }
+        if (options.optimize) {
+            Optimizer optimizer;
+            optimizer.optimize(program.statements);
+        }
+        Resolver resolver;
+        resolver.resolve(program.statements);
+        if (Error::hadError) {
+            return;
+        }
+
+        if (options.vm) {
+            Compiler compiler;
+            auto script = compiler.compile(program.statements);
+            if (Error::hadError) {
+                return;
+            }
+            VM vm;
+            vm.interpret(std::move(script));
+        } else {
+            Interpreter interpreter{options.jit, options.memo_limit};
+            interpreter.interpret(program.statements);
+        }
+    }();
+    Output::standard().flush();
+    auto output = testing::internal::GetCapturedStdout();
+
+    for (const auto& error : Error::exceptionList) {
+        output += "error: " + error.message + "\n";
+    }
+    Error::exceptionList.clear();
+    Error::hadError = false;
+    Error::hadRuntimeError = false;
+    return output;
+}
+
+#endif // SCRIPT_RUNNER_HPP
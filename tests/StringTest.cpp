@@ -0,0 +1,65 @@
+#include "ScriptRunner.hpp"
+
+// Strings of up to Value::short_capacity bytes are stored in the Value and compare equal to the
+// same characters however they were made.
+TEST(StringTest, ShortStringsAreInline) {
+    const Value short_string{"abcdefgh"};
+    const Value long_string{"abcdefghi"};
+    EXPECT_EQ(short_string.getType(), Value::Type::SHORT_STRING);
+    EXPECT_EQ(long_string.getType(), Value::Type::STRING);
+    EXPECT_EQ(concatenate(Value{"abcd"}, Value{"efgh"}), short_string);
+    EXPECT_EQ(concatenate(short_string, Value{"i"}), long_string);
+    EXPECT_EQ(concatenate(Value{""}, short_string).asString(), "abcdefgh");
+
+    const std::string source = R"(
+atom word = "ab" + "cd";
+print(word, word == "abcd", word + "efghi" == "abcdefghi", 1 + "23", "x" + 4.5);
+)";
+    const std::string expected = "abcd true true 123 x4.5 \n";
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
+
+// Concatenating long strings builds a rope that is only copied into one buffer when its characters
+// are read, and both short and long pieces end up in it in order.
+TEST(StringTest, RopesFlattenOnFirstUse) {
+    const std::string head(40, 'h');
+    Value text{head};
+    for (int i = 0; i < 20000; i++) {
+        text = concatenate(text, Value{i % 2 == 0 ? "ab" : std::string(10, 'c')});
+    }
+    ASSERT_EQ(text.getType(), Value::Type::STRING);
+    EXPECT_FALSE(text.as<StringObject>().isFlat());
+    EXPECT_EQ(text.stringLength(), head.size() + 10000u * 12u);
+
+    const auto characters = text.asString();
+    EXPECT_TRUE(text.as<StringObject>().isFlat());
+    EXPECT_EQ(characters.size(), text.stringLength());
+    EXPECT_EQ(characters.substr(0, 54), head + "ab" + std::string(10, 'c') + "ab");
+    EXPECT_EQ(characters.substr(characters.size() - 12), "ab" + std::string(10, 'c'));
+
+    // A rope that is never read is released without recursing through every node.
+    Value unread{head};
+    for (int i = 0; i < 20000; i++) {
+        unread = concatenate(Value{"ab"}, unread);
+    }
+    EXPECT_FALSE(unread.as<StringObject>().isFlat());
+}
+
+// Appending to a string in a loop gives the same text on both engines.
+TEST(StringTest, ConcatenationLoop) {
+    const std::string source = R"(
+atom text = "";
+navigate (atom i = 0; i < 5000; i++) {
+    text = text + "piece" + i;
+}
+print(text);
+)";
+    std::string expected;
+    for (int i = 0; i < 5000; i++) {
+        expected += "piece" + std::to_string(i);
+    }
+    expected += " \n";
+    EXPECT_EQ(runScript(source), expected);
+    EXPECT_EQ(runScript(source, {.vm = true}), expected);
+}
@@ -0,0 +1,202 @@
+#include "ScriptRunner.hpp"
+
+TEST(VMTest, NamesAreStoredOnceInTheConstantTable) {
+    // Far more references than a chunk has constants, to only a few hundred names.
+    std::string source;
+    for (int i = 0; i < 300; ++i) {
+        source += "atom v" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+    }
+    for (int i = 0; i < 40000; ++i) {
+        source += "v" + std::to_string(i % 300) + " = v" + std::to_string(i * 7 % 300) + ";\n";
+    }
+    source += "print(v0, v299);\n";
+
+    const auto output = runScript(source, {.vm = true});
+    EXPECT_EQ(output.find("error:"), std::string::npos) << output;
+    EXPECT_EQ(output, runScript(source));
+}
+
+TEST(VMTest, ConstantOverflowIsReportedOnce) {
+    std::string source;
+    for (int i = 0; i < 40000; ++i) {
+        source += "atom v" + std::to_string(i) + " = 0;\n";
+    }
+    EXPECT_EQ(runScript(source, {.vm = true}), "error: Too many constants in one chunk.\n");
+}
+
+TEST(VMTest, DeepRecursionGrowsTheStack) {
+    const auto source = R"(
+mission depth(n) {
+    probe (n == 0) transmit (0);
+    transmit (1 + depth(n - 1));
+}
+print(depth(3000));
+)";
+    // Past the old limit of 1024 frames. The tree-walker recurses on the native stack, which
+    // sanitizer builds fill sooner, so only the VM is run this deep.
+    EXPECT_EQ(runScript(source, {.vm = true}), "3000 \n");
+
+    // Much deeper, with a variable captured from the bottom frame while the stack moves.
+    EXPECT_EQ(runScript(R"(
+mission down(f, n) {
+    probe (n == 0) transmit (f());
+    transmit (down(f, n - 1) + 0);
+}
+mission outer() {
+    atom x = 1;
+    mission bump() { x = x + 1; transmit (x); }
+    atom r = down(bump, 100000);
+    transmit (x * 1000 + r);
+}
+print(outer());
+)", {.vm = true}), "2002 \n");
+}
+
+TEST(VMTest, UnboundedRecursionOverflows) {
+    const auto source = "mission forever(n) { transmit (1 + forever(n + 1)); }\nforever(0);\n";
+    EXPECT_EQ(runScript(source, {.vm = true}), "error: Stack overflow.\n");
+}
+
+TEST(VMTest, MissionsMayHaveManyLocals) {
+    std::string source = "mission many() {\n";
+    for (int i = 0; i < 300; ++i) {
+        source += "    atom l" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+    }
+    source += "    mission inner() { transmit (l0 + l299); }\n    transmit (inner() + l150);\n}\nprint(many());\n";
+
+    EXPECT_EQ(runScript(source, {.vm = true}), "449 \n");
+    EXPECT_EQ(runScript(source), "449 \n");
+}
+
+// The VM has to print the same as the tree-walker, errors included.
+TEST(VMTest, MatchesTheTreeEngine) {
+    const char* sources[] = {
+        R"(
+mission fib(n) {
+    probe (n < 2) transmit (n);
+    transmit (fib(n - 2) + fib(n - 1));
+}
+mission nothing() { atom z = 1; }
+mission early(n) {
+    navigate (atom i = 0; i < 10; i++) {
+        probe (i == n) transmit (i * 10);
+    }
+    transmit (-1);
+}
+mission acc(n, a) {
+    probe (n == 0) transmit (a);
+    transmit (acc(n - 1, a + n));
+}
+print(fib(15), nothing(), early(3), early(20), acc(1000, 0), fib);
+)",
+        R"(
+mission makeCounter() {
+    atom count = 0;
+    mission inc() {
+        count++;
+        transmit (count);
+    }
+    transmit (inc);
+}
+atom c1 = makeCounter();
+atom c2 = makeCounter();
+print(c1(), c1(), c1(), c2());
+mission outer() {
+    atom x = "outer";
+    mission middle() {
+        mission inner() { transmit (x); }
+        transmit (inner);
+    }
+    transmit (middle);
+}
+print(outer()()());
+atom g = 1;
+mission setg() { g = 42; }
+setg();
+print(g);
+)",
+        R"(
+atom s = "ab" + "cd";
+atom list = [1, "two", 3.5, nil, [4]];
+list[1] = s + 1;
+print(s, list, list[1], 7 / 2, 6 / 3, -0.0, 1 == 1.0, "a" == "a", !nil);
+atom i = 10;
+orbit (i > 0) {
+    i--;
+    probe (i == 7) warp;
+    elprobe (i == 3) eject;
+    blackhole print(i * 2);
+}
+)",
+    };
+    for (const char* source : sources) {
+        const auto output = runScript(source, {.vm = true});
+        EXPECT_EQ(output.find("error:"), std::string::npos) << output;
+        EXPECT_EQ(output, runScript(source)) << source;
+    }
+
+    const char* failing[] = {
+        "print(undefined);",
+        "atom x = 1;\nx();",
+        "mission f(a) { transmit (a); }\nprint(f(1, 2));",
+        "atom list = [1];\nprint(list[1]);",
+        "print(\"a\" - 1);",
+    };
+    for (const char* source : failing) {
+        const auto output = runScript(source, {.vm = true});
+        EXPECT_NE(output.find("error:"), std::string::npos) << source;
+        EXPECT_EQ(output, runScript(source)) << source;
+    }
+}
+
+// Each frame gets room for the deepest its expressions go, here far past the 256 temporaries
+// frames used to get, in every one of thousands of nested calls.
+TEST(VMTest, DeeplyNestedExpressionsFitTheirFrames) {
+    std::string nested = "x";
+    for (int i = 0; i < 300; ++i) {
+        nested = "(x + " + nested + ")";
+    }
+    const auto source = "mission f(x, n) {\n    probe (n == 0) transmit (" + nested + ");\n"
+                        "    atom r = f(x, n - 1);\n    transmit (r);\n}\nprint(f(1, 5000));\n";
+    EXPECT_EQ(runScript(source, {.vm = true}), "301 \n");
+}
+
+// Tail calls reuse the caller's frame, which has to grow when the callee has more locals, and
+// keep deep tail recursion from growing either engine's stack.
+TEST(VMTest, TailCallsReuseTheFrame) {
+    std::string source = "mission big(n) {\n";
+    for (int i = 0; i < 700; ++i) {
+        source += "    atom l" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+    }
+    source += R"(    transmit (n + l699);
+}
+mission small(n) {
+    probe (n == 0) transmit (big(1));
+    transmit (small(n - 1));
+}
+mission count(n, total) {
+    probe (n == 0) transmit (total);
+    transmit (count(n - 1, total + n));
+}
+print(small(100000), count(100000, 0));
+)";
+    EXPECT_EQ(runScript(source, {.vm = true}), "700 5000050000 \n");
+    EXPECT_EQ(runScript(source), "700 5000050000 \n");
+}
+
+// Indices are checked as 64-bit integers, so huge ones are out of range rather than wrapped.
+TEST(VMTest, IndicesOutsideIntAreOutOfRange) {
+    const char* sources[] = {
+        "atom list = [1, 2];\nprint(list[4294967296]);",
+        "atom list = [1, 2];\nprint(list[4294967297.0]);",
+        "atom list = [1, 2];\nprint(list[-4294967296]);",
+        "atom xs = array(2);\nxs[1e300] = 1;",
+        "atom list = [1, 2];\nprint(list[0.5]);",
+    };
+    for (const char* source : sources) {
+        const auto output = runScript(source, {.vm = true});
+        EXPECT_NE(output.find("error:"), std::string::npos) << source;
+        EXPECT_EQ(output, runScript(source)) << source;
+    }
+    EXPECT_EQ(runScript(sources[0], {.vm = true}), "error: Index out of range. Index is 4294967296 but object size is 2\n");
+}